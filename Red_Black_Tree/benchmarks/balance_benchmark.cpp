@@ -0,0 +1,87 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "../source/rb_tree.hpp"
+
+/*
+ * Red-black, AVL and WAVL balancing behind the same RBTree: height after random and sorted loads,
+ * lookup cost, and insert/erase cost with the rotations and color/rank changes they take
+ * Build: g++ -std=c++20 -O2 -I../source balance_benchmark.cpp -o balance_benchmark
+ */
+
+constexpr int keys{ 1000000 };
+constexpr int lookups{ 2000000 };
+constexpr int updates{ 1000000 };
+
+struct BalanceTag {};
+
+typedef ads::ds::rbt::stats::Counting<BalanceTag> counting_t;
+
+template <typename Balance>
+void run(const char* name, const std::vector<int>& random, const std::vector<int>& probes) {
+    typedef ads::ds::rbt::RBTree<int, ads::ds::rbt::augment::NoAugmentation, counting_t, Balance> tree_t;
+
+    tree_t sorted;
+
+    for (auto i = 0; i < keys; ++i) sorted.insert(i);
+
+    auto sorted_height = sorted.shape_report().height;
+    tree_t tree;
+
+    counting_t::reset();
+    auto begin = std::chrono::steady_clock::now();
+
+    for (auto k : random) tree.insert(k);
+
+    std::chrono::duration<double> insert_time = std::chrono::steady_clock::now() - begin;
+    auto insert_stats = counting_t::snapshot();
+    auto shape = tree.shape_report();
+
+    counting_t::reset();
+    std::size_t hits = 0;
+    begin = std::chrono::steady_clock::now();
+
+    for (auto k : probes) hits += tree.find(k);
+
+    std::chrono::duration<double> find_time = std::chrono::steady_clock::now() - begin;
+    auto find_stats = counting_t::snapshot();
+
+    // Erases a key and inserts a fresh one, the size stays put
+    std::mt19937 gen(7);
+    counting_t::reset();
+    begin = std::chrono::steady_clock::now();
+
+    for (auto i = 0; i < updates; ++i) {
+        tree.remove(random[static_cast<std::size_t>(i)]);
+        tree.insert(static_cast<int>(gen() >> 1));
+    }
+
+    std::chrono::duration<double> update_time = std::chrono::steady_clock::now() - begin;
+    auto update_stats = counting_t::snapshot();
+    auto churned = tree.shape_report();
+
+    std::cout << name << "\n";
+    std::cout << "  height random/sorted/after churn: " << shape.height << " / " << sorted_height << " / " << churned.height
+              << " (bound " << shape.height_bound << "), average depth " << shape.average_depth << " / " << churned.average_depth << "\n";
+    std::cout << "  insert: " << insert_time.count() / keys * 1e9 << " ns/op, rotations/op " << static_cast<double>(insert_stats.rotations) / keys
+              << ", recolors/op " << static_cast<double>(insert_stats.recolors) / keys << "\n";
+    std::cout << "  find:   " << find_time.count() / lookups * 1e9 << " ns/op, comparisons/op " << find_stats.comparisons_per_descent() << " (" << hits << " hits)\n";
+    std::cout << "  update: " << update_time.count() / updates * 1e9 << " ns/op, rotations/op " << static_cast<double>(update_stats.rotations) / updates
+              << ", recolors/op " << static_cast<double>(update_stats.recolors) / updates << "\n";
+}
+
+int main() {
+    std::mt19937 gen(42);
+    std::vector<int> random;
+    std::vector<int> probes;
+
+    for (auto i = 0; i < keys; ++i) random.push_back(static_cast<int>(gen() >> 1));
+    for (auto i = 0; i < lookups; ++i) probes.push_back(random[gen() % random.size()] + static_cast<int>(gen() % 2));
+
+    run<ads::ds::rbt::balance::RedBlack>("red-black", random, probes);
+    run<ads::ds::rbt::balance::AVL>("AVL", random, probes);
+    run<ads::ds::rbt::balance::WAVL>("WAVL", random, probes);
+
+    return 0;
+}
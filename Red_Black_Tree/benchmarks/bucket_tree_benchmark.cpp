@@ -0,0 +1,58 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "../source/rb_tree.hpp"
+#include "../source/rbt_bucket_tree.hpp"
+
+/*
+ * RBTree<int> against BucketRBTree<int, B> for a few bucket sizes: bytes per key, insert and lookup time
+ * Build: g++ -std=c++20 -O2 -I../source bucket_tree_benchmark.cpp -o bucket_tree_benchmark
+ */
+
+constexpr int keys{ 1000000 };
+constexpr int lookups{ 2000000 };
+
+template <typename Tree>
+void run(const char* name, const std::vector<int>& random, const std::vector<int>& probes, double bytes_per_key(const Tree&)) {
+    Tree tree;
+    auto begin = std::chrono::steady_clock::now();
+
+    for (auto k : random) tree.insert(k);
+
+    std::chrono::duration<double> insert_time = std::chrono::steady_clock::now() - begin;
+    std::size_t hits = 0;
+    begin = std::chrono::steady_clock::now();
+
+    for (auto k : probes) hits += tree.find(k);
+
+    std::chrono::duration<double> find_time = std::chrono::steady_clock::now() - begin;
+
+    std::cout << name << ": " << bytes_per_key(tree) << " bytes/key, insert " << insert_time.count() / keys * 1e9 << " ns/op, find "
+              << find_time.count() / lookups * 1e9 << " ns/op (" << hits << " hits)\n";
+}
+
+template <std::size_t B>
+void run_buckets(const char* name, const std::vector<int>& random, const std::vector<int>& probes) {
+    typedef ads::ds::rbt::BucketRBTree<int, B> tree_t;
+
+    run<tree_t>(name, random, probes, [](const tree_t& t) { return static_cast<double>(t.buckets() * sizeof(typename tree_t::node_t)) / static_cast<double>(t.size()); });
+}
+
+int main() {
+    typedef ads::ds::rbt::RBTree<int> tree_t;
+
+    std::mt19937 gen(42);
+    std::vector<int> random;
+    std::vector<int> probes;
+
+    for (auto i = 0; i < keys; ++i) random.push_back(static_cast<int>(gen() >> 1));
+    for (auto i = 0; i < lookups; ++i) probes.push_back(random[gen() % random.size()] + static_cast<int>(gen() % 2));
+
+    run<tree_t>("RBTree<int>          ", random, probes, [](const tree_t&) { return static_cast<double>(sizeof(tree_t::node_t)); });
+    run_buckets<16>("BucketRBTree<int, 16>", random, probes);
+    run_buckets<32>("BucketRBTree<int, 32>", random, probes);
+    run_buckets<64>("BucketRBTree<int, 64>", random, probes);
+
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "../source/rbt_interval_tree.hpp"
+
+/*
+ * RBIntervalTree against a linear scan over the same reservations
+ * Build: g++ -std=c++20 -O2 -I../source interval_tree_benchmark.cpp -o interval_tree_benchmark
+ */
+
+constexpr int reservations{ 1000000 };
+constexpr int queries{ 10000 };
+constexpr int horizon{ 100000000 };
+
+int main() {
+    std::mt19937_64 gen(42);
+    std::uniform_int_distribution<int> start(0, horizon);
+    std::uniform_int_distribution<int> length(1, 5000);
+    std::vector<ads::ds::rbt::Interval<int>> scan;
+    ads::ds::rbt::RBIntervalTree<int> tree;
+
+    for (auto i = 0; i < reservations; ++i) {
+        auto t1 = start(gen);
+        auto t2 = t1 + length(gen);
+
+        if (tree.insert(t1, t2)) scan.push_back({ t1, t2 });
+    }
+
+    std::vector<std::pair<int, int>> windows;
+
+    for (auto i = 0; i < queries; ++i) {
+        auto t1 = start(gen);
+        windows.emplace_back(t1, t1 + length(gen));
+    }
+
+    std::size_t found_tree = 0;
+    auto begin = std::chrono::steady_clock::now();
+
+    for (auto& w : windows) {
+        tree.for_each_overlapping(w.first, w.second, [&found_tree](const ads::ds::rbt::Interval<int>&) { found_tree++; });
+    }
+
+    std::chrono::duration<double> tree_time = std::chrono::steady_clock::now() - begin;
+    std::size_t found_scan = 0;
+    begin = std::chrono::steady_clock::now();
+
+    for (auto& w : windows) {
+        for (auto& r : scan) {
+            if (r.overlaps(w.first, w.second)) found_scan++;
+        }
+    }
+
+    std::chrono::duration<double> scan_time = std::chrono::steady_clock::now() - begin;
+    std::size_t any_tree = 0;
+    begin = std::chrono::steady_clock::now();
+
+    for (auto& w : windows) {
+        if (tree.any_overlap(w.first, w.second)) any_tree++;
+    }
+
+    std::chrono::duration<double> any_time = std::chrono::steady_clock::now() - begin;
+
+    std::cout << "intervals: " << scan.size() << ", queries: " << queries << ", overlaps reported: " << found_tree << "\n";
+    std::cout << "overlapping() tree:  " << tree_time.count() / queries * 1e9 << " ns/query" << "\n";
+    std::cout << "overlapping() scan:  " << scan_time.count() / queries * 1e9 << " ns/query" << "\n";
+    std::cout << "any_overlap() tree:  " << any_time.count() / queries * 1e9 << " ns/query (" << any_tree << " hits)" << "\n";
+
+    return found_tree == found_scan ? 0 : 1;
+}
@@ -0,0 +1,105 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "../source/rb_tree.hpp"
+#include "../source/rbt_prefixed_string.hpp"
+
+/*
+ * RBTree<std::string> against RBTree<PrefixedString> on URL and file path keys: insert and lookup time
+ * Keys are made up of host, directory and file names drawn from small vocabularies, the way crawl
+ * frontiers and file indexes look. Full URLs all start with "https://" and tie on the inline prefix,
+ * the same URLs without the scheme (host first) show the case the prefix is meant for.
+ * Build: g++ -std=c++20 -O2 -I../source prefixed_string_benchmark.cpp -o prefixed_string_benchmark
+ */
+
+constexpr int keys{ 200000 };
+constexpr int lookups{ 500000 };
+
+const std::vector<std::string> words{ "alpha", "beta", "news", "shop", "mail", "docs", "static", "media", "blog", "forum",
+                                      "video", "maps", "cloud", "data", "store", "wiki", "search", "login", "assets", "api" };
+const std::vector<std::string> tlds{ ".com", ".org", ".net", ".io", ".de", ".co.uk" };
+const std::vector<std::string> files{ "index.html", "main.js", "style.css", "logo.png", "README.md", "app.cpp", "util.hpp", "config.json" };
+
+std::string pick(const std::vector<std::string>& v, std::mt19937& gen) {
+    return v[gen() % v.size()];
+}
+
+std::string url(std::mt19937& gen, bool scheme) {
+    auto s = std::string(scheme ? "https://" : "");
+    s += (gen() % 3 == 0 ? "www." : "") + pick(words, gen) + std::to_string(gen() % 500) + pick(tlds, gen);
+
+    for (auto depth = gen() % 4; depth > 0; --depth) s += "/" + pick(words, gen);
+
+    return s + "/" + std::to_string(gen() % 1000) + "/" + pick(files, gen);
+}
+
+std::string path(std::mt19937& gen) {
+    static const std::vector<std::string> roots{ "/home/", "/usr/lib/", "/usr/share/", "/var/log/", "/opt/", "/srv/", "/etc/" };
+    auto s = pick(roots, gen) + pick(words, gen) + std::to_string(gen() % 200);
+
+    for (auto depth = gen() % 4; depth > 0; --depth) s += "/" + pick(words, gen);
+
+    return s + "/" + std::to_string(gen() % 1000) + "_" + pick(files, gen);
+}
+
+template <typename Key>
+void run(const char* name, const std::vector<std::string>& load, const std::vector<std::string>& probes) {
+    std::vector<Key> load_keys(load.begin(), load.end());
+    std::vector<Key> probe_keys(probes.begin(), probes.end());
+    ads::ds::rbt::RBTree<Key> tree;
+
+    auto begin = std::chrono::steady_clock::now();
+
+    for (auto& k : load_keys) tree.insert(k);
+
+    std::chrono::duration<double> insert_time = std::chrono::steady_clock::now() - begin;
+    std::size_t hits = 0;
+    begin = std::chrono::steady_clock::now();
+
+    for (auto& k : probe_keys) hits += tree.find(k);
+
+    std::chrono::duration<double> find_time = std::chrono::steady_clock::now() - begin;
+
+    std::cout << "  " << name << ": insert " << insert_time.count() / keys * 1e9 << " ns/op, find " << find_time.count() / lookups * 1e9
+              << " ns/op (" << hits << " hits)\n";
+
+    // Share of the nodes on the search paths whose inline prefix ties with the probe
+    if constexpr (std::is_same_v<Key, ads::ds::rbt::PrefixedString>) {
+        std::size_t visited = 0;
+        std::size_t ties = 0;
+
+        for (auto& k : probe_keys) {
+            for (auto* n = tree.getRoot(); n != nullptr && !(n->key == k); n = (k < n->key ? n->left : n->right)) {
+                ++visited;
+                ties += (n->key.prefix() == k.prefix());
+            }
+        }
+
+        std::cout << "  prefix ties on " << 100.0 * static_cast<double>(ties) / static_cast<double>(visited) << "% of the comparisons\n";
+    }
+}
+
+template <typename Make>
+void workload(const char* name, Make make) {
+    std::mt19937 gen(42);
+    std::vector<std::string> load;
+    std::vector<std::string> probes;
+
+    for (auto i = 0; i < keys; ++i) load.push_back(make(gen));
+    for (auto i = 0; i < lookups; ++i) probes.push_back(gen() % 2 == 0 ? load[gen() % load.size()] : make(gen));
+
+    std::cout << name << "\n";
+    run<std::string>("std::string   ", load, probes);
+    run<ads::ds::rbt::PrefixedString>("PrefixedString", load, probes);
+}
+
+int main() {
+    workload("host + path", [](std::mt19937& gen) { return url(gen, false); });
+    workload("file paths", [](std::mt19937& gen) { return path(gen); });
+    workload("full URLs (https:// on every key)", [](std::mt19937& gen) { return url(gen, true); });
+
+    return 0;
+}
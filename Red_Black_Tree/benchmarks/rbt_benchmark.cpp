@@ -0,0 +1,401 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "../source/rb_tree.hpp"
+
+/*
+ * Benchmark suite: RBTree against std::set and std::map on the same workloads
+ * Build: g++ -std=c++20 -O2 -DNDEBUG -I../source rbt_benchmark.cpp -o rbt_benchmark
+ * Run:   ./rbt_benchmark [--n=1000000] [--ops=1000000] [--format=csv|json]
+ *                        [--workloads=a,b,..] [--keys=int,uint64,string] [--containers=rbtree,set,map]
+ *
+ * Every case runs in a forked child, so the reported peak RSS (getrusage) belongs to that case only.
+ * Operations are timed in batches of batch_ops, percentiles are taken over the per batch averages.
+ */
+
+namespace {
+
+    constexpr std::size_t batch_ops{ 32 };
+    constexpr std::size_t scan_length{ 100 };
+    constexpr double      zipf_skew{ 0.99 };
+
+    struct Options {
+        std::size_t              n{ 1000000 };
+        std::size_t              ops{ 1000000 };
+        std::string              format{ "csv" };
+        std::vector<std::string> workloads{ "sequential_insert", "random_insert", "random_find", "zipf_find", "mixed", "range_scan", "erase_heavy" };
+        std::vector<std::string> keys{ "int", "uint64", "string" };
+        std::vector<std::string> containers{ "rbtree", "set", "map" };
+    };
+
+    struct Result {
+        double      ns_per_op{ 0 };
+        double      p50{ 0 };
+        double      p90{ 0 };
+        double      p99{ 0 };
+        double      p999{ 0 };
+        std::size_t ops{ 0 };
+        long        peak_rss_kb{ 0 };
+        std::size_t checksum{ 0 };
+    };
+
+    /**
+        * Keys
+    */
+    template <typename K>
+    K make_key(std::uint64_t x) { return static_cast<K>(x); }
+
+    // Path like keys sharing a long prefix, the common case for string indexes
+    template <>
+    std::string make_key<std::string>(std::uint64_t x) {
+        char buffer[40];
+        std::snprintf(buffer, sizeof(buffer), "/users/%016llx", static_cast<unsigned long long>(x));
+
+        return buffer;
+    }
+
+    /**
+        * Containers, one interface for all of them
+    */
+    template <typename K>
+    struct RBTreeAdapter {
+        ads::ds::rbt::RBTree<K> t;
+
+        void        insert(const K& k) { t.insert(k); }
+        bool        find(const K& k)   { return t.node_find(k) != nullptr; }
+        bool        erase(const K& k)  { auto* p = t.node_find(k); if (p == nullptr) return false; delete t.node_extract(p); return true; }
+        std::size_t scan(const K& k, std::size_t length) {
+            std::size_t seen = 0;
+            for (auto it = t.lower_bound(k); it != t.end() && seen < length; ++it) ++seen;
+            return seen;
+        }
+    };
+
+    template <typename K>
+    struct SetAdapter {
+        std::set<K> t;
+
+        void        insert(const K& k) { t.insert(k); }
+        bool        find(const K& k)   { return t.find(k) != t.end(); }
+        bool        erase(const K& k)  { return t.erase(k) != 0; }
+        std::size_t scan(const K& k, std::size_t length) {
+            std::size_t seen = 0;
+            for (auto it = t.lower_bound(k); it != t.end() && seen < length; ++it) ++seen;
+            return seen;
+        }
+    };
+
+    template <typename K>
+    struct MapAdapter {
+        std::map<K, std::uint32_t> t;
+
+        void        insert(const K& k) { t.emplace(k, 0); }
+        bool        find(const K& k)   { return t.find(k) != t.end(); }
+        bool        erase(const K& k)  { return t.erase(k) != 0; }
+        std::size_t scan(const K& k, std::size_t length) {
+            std::size_t seen = 0;
+            for (auto it = t.lower_bound(k); it != t.end() && seen < length; ++it) ++seen;
+            return seen;
+        }
+    };
+
+    /**
+        * Timing
+    */
+    class Timer {
+    public:
+        explicit Timer(std::size_t ops) { batches_.reserve(ops / batch_ops + 1); }
+
+        // op(i) runs operation i, returns something to keep the optimizer honest
+        template <typename Op>
+        void run(std::size_t ops, Op op) {
+            for (std::size_t done = 0; done < ops; ) {
+                auto batch = std::min(batch_ops, ops - done);
+                auto start = std::chrono::steady_clock::now();
+
+                for (std::size_t i = 0; i < batch; ++i) checksum_ += static_cast<std::size_t>(op(done + i));
+
+                auto end = std::chrono::steady_clock::now();
+                batches_.push_back(std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(batch));
+                total_ += std::chrono::duration<double, std::nano>(end - start).count();
+                done += batch;
+            }
+
+            ops_ += ops;
+        }
+
+        Result result() {
+            Result r;
+
+            if (batches_.empty()) return r;
+
+            std::sort(batches_.begin(), batches_.end());
+
+            auto at = [this](double q) { return batches_[std::min(batches_.size() - 1, static_cast<std::size_t>(q * static_cast<double>(batches_.size())))]; };
+
+            r.ns_per_op = total_ / static_cast<double>(ops_);
+            r.p50 = at(0.5);
+            r.p90 = at(0.9);
+            r.p99 = at(0.99);
+            r.p999 = at(0.999);
+            r.ops = ops_;
+            r.checksum = checksum_;
+
+            return r;
+        }
+
+    private:
+        std::vector<double> batches_;
+        double              total_{ 0 };
+        std::size_t         ops_{ 0 };
+        std::size_t         checksum_{ 0 };
+    };
+
+    // Continuous approximation of a Zipf distribution over ranks [0, n)
+    class Zipf {
+    public:
+        Zipf(std::size_t n, double s) : n_{ static_cast<double>(n) }, s_{ s } {}
+
+        template <typename Gen>
+        std::size_t operator()(Gen& gen) {
+            auto u = std::uniform_real_distribution<double>(0.0, 1.0)(gen);
+            auto x = std::pow((std::pow(n_, 1.0 - s_) - 1.0) * u + 1.0, 1.0 / (1.0 - s_));
+
+            return std::min(static_cast<std::size_t>(x) - 1, static_cast<std::size_t>(n_) - 1);
+        }
+
+    private:
+        double n_;
+        double s_;
+    };
+
+    /**
+        * Workloads
+    */
+    template <typename K, typename C>
+    Result run_workload(const std::string& workload, const Options& o) {
+        std::mt19937_64 gen(2024);
+        std::vector<K> keys;
+        C c;
+
+        keys.reserve(o.n);
+
+        for (std::size_t i = 0; i < o.n; ++i) keys.push_back(make_key<K>(gen() >> 2));
+
+        Timer timer(std::max(o.n, o.ops));
+
+        auto prefill = [&] { for (auto& k : keys) c.insert(k); };
+
+        if (workload == "sequential_insert") {
+            std::vector<K> sorted;
+            for (std::size_t i = 0; i < o.n; ++i) sorted.push_back(make_key<K>(i));
+
+            timer.run(o.n, [&](std::size_t i) { c.insert(sorted[i]); return 0; });
+        }
+        else if (workload == "random_insert") {
+            timer.run(o.n, [&](std::size_t i) { c.insert(keys[i]); return 0; });
+        }
+        else if (workload == "random_find") {
+            prefill();
+
+            std::vector<std::size_t> probes;
+            for (std::size_t i = 0; i < o.ops; ++i) probes.push_back(gen() % o.n);
+
+            timer.run(o.ops, [&](std::size_t i) { return c.find(keys[probes[i]]); });
+        }
+        else if (workload == "zipf_find") {
+            prefill();
+
+            // Hot ranks are spread over the key space, not clustered at the smallest keys
+            Zipf zipf(o.n, zipf_skew);
+            std::vector<std::size_t> probes;
+            for (std::size_t i = 0; i < o.ops; ++i) probes.push_back(zipf(gen));
+
+            timer.run(o.ops, [&](std::size_t i) { return c.find(keys[probes[i]]); });
+        }
+        else if (workload == "mixed") {
+            prefill();
+
+            // 90% Zipf reads, 5% inserts of fresh keys, 5% erases of existing ones
+            Zipf zipf(o.n, zipf_skew);
+            std::vector<std::pair<int, K>> plan;
+            for (std::size_t i = 0; i < o.ops; ++i) {
+                auto dice = gen() % 20;
+                if (dice == 0) plan.emplace_back(1, make_key<K>(gen() >> 2));
+                else if (dice == 1) plan.emplace_back(2, keys[gen() % o.n]);
+                else plan.emplace_back(0, keys[zipf(gen)]);
+            }
+
+            timer.run(o.ops, [&](std::size_t i) {
+                auto& [op, k] = plan[i];
+                if (op == 1) { c.insert(k); return true; }
+                if (op == 2) return c.erase(k);
+                return c.find(k);
+            });
+        }
+        else if (workload == "range_scan") {
+            prefill();
+
+            auto scans = std::max<std::size_t>(o.ops / scan_length, 1);
+            std::vector<K> starts;
+            for (std::size_t i = 0; i < scans; ++i) starts.push_back(make_key<K>(gen() >> 2));
+
+            timer.run(scans, [&](std::size_t i) { return c.scan(starts[i], scan_length); });
+        }
+        else if (workload == "erase_heavy") {
+            prefill();
+
+            std::vector<K> order(keys);
+            std::shuffle(order.begin(), order.end(), gen);
+
+            timer.run(order.size(), [&](std::size_t i) { return c.erase(order[i]); });
+        }
+        else {
+            std::cerr << "Unknown workload " << workload << "\n";
+            std::exit(2);
+        }
+
+        auto r = timer.result();
+
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+        r.peak_rss_kb = usage.ru_maxrss;
+
+        return r;
+    }
+
+    template <typename K>
+    Result run_container(const std::string& container, const std::string& workload, const Options& o) {
+        if (container == "rbtree") return run_workload<K, RBTreeAdapter<K>>(workload, o);
+        if (container == "set") return run_workload<K, SetAdapter<K>>(workload, o);
+        if (container == "map") return run_workload<K, MapAdapter<K>>(workload, o);
+
+        std::cerr << "Unknown container " << container << "\n";
+        std::exit(2);
+    }
+
+    Result run_case(const std::string& container, const std::string& key, const std::string& workload, const Options& o) {
+        if (key == "int") return run_container<int>(container, workload, o);
+        if (key == "uint64") return run_container<std::uint64_t>(container, workload, o);
+        if (key == "string") return run_container<std::string>(container, workload, o);
+
+        std::cerr << "Unknown key type " << key << "\n";
+        std::exit(2);
+    }
+
+    // Runs one case in a child process and reads its Result back through a pipe
+    bool run_isolated(const std::string& container, const std::string& key, const std::string& workload, const Options& o, Result& r) {
+        int fds[2];
+
+        if (pipe(fds) != 0) return false;
+
+        auto pid = fork();
+
+        if (pid == 0) {
+            close(fds[0]);
+            auto child = run_case(container, key, workload, o);
+            auto written = write(fds[1], &child, sizeof(child));
+            _exit(written == static_cast<ssize_t>(sizeof(child)) ? 0 : 1);
+        }
+
+        close(fds[1]);
+
+        auto got = read(fds[0], &r, sizeof(r));
+        int status = 0;
+
+        close(fds[0]);
+        waitpid(pid, &status, 0);
+
+        return pid > 0 && got == static_cast<ssize_t>(sizeof(r)) && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+
+    std::vector<std::string> split_list(const std::string& s) {
+        std::vector<std::string> out;
+        std::stringstream in(s);
+
+        for (std::string item; std::getline(in, item, ','); ) {
+            if (!item.empty()) out.push_back(item);
+        }
+
+        return out;
+    }
+
+    Options parse(int argc, char** argv) {
+        Options o;
+
+        for (auto i = 1; i < argc; ++i) {
+            std::string arg(argv[i]);
+            auto eq = arg.find('=');
+            auto name = arg.substr(0, eq);
+            auto value = (eq == std::string::npos ? std::string() : arg.substr(eq + 1));
+
+            if (name == "--n") o.n = std::stoull(value);
+            else if (name == "--ops") o.ops = std::stoull(value);
+            else if (name == "--format") o.format = value;
+            else if (name == "--workloads") o.workloads = split_list(value);
+            else if (name == "--keys") o.keys = split_list(value);
+            else if (name == "--containers") o.containers = split_list(value);
+            else {
+                std::cerr << "Unknown option " << arg << "\n";
+                std::exit(2);
+            }
+        }
+
+        o.n = std::max<std::size_t>(o.n, 1);
+
+        return o;
+    }
+
+}
+
+int main(int argc, char** argv) {
+    auto o = parse(argc, argv);
+    auto json = (o.format == "json");
+    auto first = true;
+
+    if (json) std::cout << "[\n";
+    else std::cout << "container,key,workload,n,ops,ns_per_op,p50_ns,p90_ns,p99_ns,p999_ns,peak_rss_kb\n";
+
+    for (auto& workload : o.workloads) {
+        for (auto& key : o.keys) {
+            for (auto& container : o.containers) {
+                Result r;
+
+                if (!run_isolated(container, key, workload, o, r)) {
+                    std::cerr << "Case " << container << "/" << key << "/" << workload << " failed\n";
+                    return 1;
+                }
+
+                if (json) {
+                    std::cout << (first ? "" : ",\n") << "  {\"container\": \"" << container << "\", \"key\": \"" << key << "\", \"workload\": \"" << workload
+                              << "\", \"n\": " << o.n << ", \"ops\": " << r.ops << ", \"ns_per_op\": " << r.ns_per_op << ", \"p50_ns\": " << r.p50
+                              << ", \"p90_ns\": " << r.p90 << ", \"p99_ns\": " << r.p99 << ", \"p999_ns\": " << r.p999 << ", \"peak_rss_kb\": " << r.peak_rss_kb << "}";
+                }
+                else {
+                    std::cout << container << "," << key << "," << workload << "," << o.n << "," << r.ops << "," << r.ns_per_op << "," << r.p50 << ","
+                              << r.p90 << "," << r.p99 << "," << r.p999 << "," << r.peak_rss_kb << "\n";
+                }
+
+                first = false;
+                std::cout.flush();
+            }
+        }
+    }
+
+    if (json) std::cout << "\n]\n";
+
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "../source/rbt_rolling_quantiles.hpp"
+
+/*
+ * p50/p99 over a sliding window of 1M latency samples: RollingQuantiles against sorting a copy of the
+ * window for every report. Samples are log-normal, the way request latencies spread.
+ * Build: g++ -std=c++20 -O2 -I../source rolling_quantiles_benchmark.cpp -o rolling_quantiles_benchmark
+ */
+
+constexpr std::size_t window{ 1000000 };
+constexpr std::size_t events{ 4000000 };
+constexpr std::size_t report_every{ 10000 };
+constexpr std::size_t sorted_reports{ 5 };
+
+int main() {
+    std::mt19937 gen(42);
+    std::lognormal_distribution<double> latency(3.0, 0.8);
+    std::vector<double> samples;
+
+    for (std::size_t i = 0; i < window + events; ++i) samples.push_back(latency(gen));
+
+    ads::ds::rbt::RollingQuantiles<double> rolling(window);
+
+    auto begin = std::chrono::steady_clock::now();
+
+    for (std::size_t i = 0; i < window; ++i) rolling.push(samples[i]);
+
+    std::chrono::duration<double> fill_time = std::chrono::steady_clock::now() - begin;
+    double checksum = 0.0;
+    std::size_t reports = 0;
+    begin = std::chrono::steady_clock::now();
+
+    for (std::size_t i = window; i < window + events; ++i) {
+        rolling.push(samples[i]);
+
+        if ((i - window) % report_every == 0) {
+            checksum += rolling.quantile(0.5) + rolling.quantile(0.99);
+            reports++;
+        }
+    }
+
+    std::chrono::duration<double> run_time = std::chrono::steady_clock::now() - begin;
+
+    // The same reports from a sorted copy of the window, timed for a few of them
+    std::deque<double> copy(samples.end() - static_cast<std::ptrdiff_t>(window), samples.end());
+    std::chrono::duration<double> sort_time{ 0 };
+    double sorted_checksum = 0.0;
+
+    for (std::size_t r = 0; r < sorted_reports; ++r) {
+        begin = std::chrono::steady_clock::now();
+
+        std::vector<double> sorted(copy.begin(), copy.end());
+        std::sort(sorted.begin(), sorted.end());
+        sorted_checksum += sorted[window / 2 - 1] + sorted[window * 99 / 100 - 1];
+
+        sort_time += std::chrono::steady_clock::now() - begin;
+    }
+
+    auto per_event = run_time.count() / static_cast<double>(events);
+    auto per_sort_report = sort_time.count() / static_cast<double>(sorted_reports);
+
+    std::cout << "window " << window << ", " << events << " events, a p50/p99 report every " << report_every << " events\n";
+    std::cout << "RollingQuantiles: fill " << fill_time.count() / static_cast<double>(window) * 1e9 << " ns/sample, "
+              << per_event * 1e9 << " ns/event with expiry and reports, " << 1.0 / per_event / 1e6 << " M events/s ("
+              << reports << " reports, checksum " << checksum << ")\n";
+    std::cout << "sorted copy:      " << per_sort_report * 1e3 << " ms/report, at this report rate "
+              << (per_sort_report / static_cast<double>(report_every)) * 1e9 << " ns/event on top of the window upkeep (checksum "
+              << sorted_checksum << ")\n";
+    std::cout << "current window:   p50 " << rolling.quantile(0.5) << ", p99 " << rolling.quantile(0.99) << "\n";
+
+    return 0;
+}
@@ -0,0 +1,74 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+#include "../source/rb_tree.hpp"
+#include "../source/rbt_sharded_tree.hpp"
+
+/*
+ * Insert scaling over thread counts: ShardedRBTree<int> against one RBTree<int> behind a mutex
+ * Every thread inserts its own slice of a shuffled key set, reported as million inserts per second
+ * Build: g++ -std=c++20 -O2 -pthread -I../source sharded_tree_benchmark.cpp -o sharded_tree_benchmark
+ */
+
+constexpr int keys{ 2000000 };
+constexpr std::size_t shards{ 64 };
+
+class LockedRBTree {
+public:
+    bool insert(int x) { std::lock_guard<std::mutex> lock(lock_); return static_cast<bool>(tree_.insert(x)); };
+    std::size_t size() const { return tree_.size(); };
+
+private:
+    ads::ds::rbt::RBTree<int> tree_;
+    std::mutex                lock_;
+};
+
+template <typename Tree>
+double run(Tree& tree, const std::vector<int>& random, unsigned threads) {
+    std::vector<std::thread> pool;
+    auto slice = random.size() / threads;
+    auto begin = std::chrono::steady_clock::now();
+
+    for (unsigned t = 0; t < threads; ++t) {
+        auto from = random.begin() + static_cast<std::ptrdiff_t>(slice * t);
+        auto to = (t + 1 == threads ? random.end() : from + static_cast<std::ptrdiff_t>(slice));
+
+        pool.emplace_back([&tree, from, to] { for (auto it = from; it != to; ++it) tree.insert(*it); });
+    }
+
+    for (auto& th : pool) th.join();
+
+    std::chrono::duration<double> time = std::chrono::steady_clock::now() - begin;
+
+    return static_cast<double>(random.size()) / time.count() / 1e6;
+}
+
+int main() {
+    std::mt19937 gen(42);
+    std::vector<int> random(keys);
+
+    for (auto i = 0; i < keys; ++i) random[static_cast<std::size_t>(i)] = i;
+
+    std::shuffle(random.begin(), random.end(), gen);
+
+    auto most = std::max(1u, std::thread::hardware_concurrency());
+
+    for (unsigned threads = 1;; threads = std::min(threads * 2, most)) {
+        LockedRBTree locked;
+        ads::ds::rbt::ShardedRBTree<int> sharded(shards, 0, keys);
+
+        auto locked_rate = run(locked, random, threads);
+        auto sharded_rate = run(sharded, random, threads);
+
+        std::cout << threads << " threads: RBTree + mutex " << locked_rate << " M/s, ShardedRBTree (" << shards << " shards) "
+                  << sharded_rate << " M/s (" << locked.size() << ", " << sharded.size() << " keys)\n";
+
+        if (threads == most) break;
+    }
+
+    return 0;
+}
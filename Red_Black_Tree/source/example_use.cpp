@@ -1,19 +1,11 @@
 #include <iostream>
-#include <iomanip>
-#include <chrono>
-#include <thread>
 #include "rb_tree.hpp"
 
 
-constexpr int test1{ 10000 };        // 10^4
-constexpr int test2{ 100000 };       // 10^5
-constexpr int test3{ 1000000 };      // 10^6
-constexpr int test4{ 10000000 };     // 10^7
-
 int main() {
     // Simple test
     {
-        algo::ds::rbt::RBTree<int> tree;
+        ads::ds::rbt::RBTree<int> tree;
         if (tree.isEmpty()) std::cout << "Tree is empty" << "\n" << "\n";
 
         for (auto i = 0; i < 20; i++) {
@@ -73,10 +65,10 @@ int main() {
         std::cout << "\n" << "\n" << "Testing operator[] (and node operator[]):" << "\n";
         std::cout << "for i = 1 key value = " << tree[1] << "\n";
         std::cout << "for i = 7 key value = " << tree[7] << "\n" << "\n";
-        algo::ds::rbt::node_impl::RBNode<int> r(5);
-        r.father = new algo::ds::rbt::node_impl::RBNode<int>(1);
-        r.left = new algo::ds::rbt::node_impl::RBNode<int>(3);
-        r.right = new algo::ds::rbt::node_impl::RBNode<int>(8);
+        ads::ds::rbt::node_impl::RBNode<int> r(5);
+        r.father = new ads::ds::rbt::node_impl::RBNode<int>(1);
+        r.left = new ads::ds::rbt::node_impl::RBNode<int>(3);
+        r.right = new ads::ds::rbt::node_impl::RBNode<int>(8);
         std::cout << "test node: " << "\n";
         r.print_node();
         std::cout << "in node for i = 0 (self) key value = " << r[0] << "\n";
@@ -85,7 +77,7 @@ int main() {
         std::cout << "in node for i = 3 (right) key value = " << r[3] << "\n";
 
         std::cout << "\n" << "\n" << "\n" << "\n";
-        algo::ds::rbt::RBTree<int> tree2 = tree;
+        ads::ds::rbt::RBTree<int> tree2 = tree;
         tree.remove(2);
         tree2.insert(42);
         std::cout << "\n";
@@ -100,7 +92,7 @@ int main() {
 
         std::cout << "\n" << "\n" << "\n" << "\n";
 
-        algo::ds::rbt::RBTree<int> t;
+        ads::ds::rbt::RBTree<int> t;
         for (auto i = 0; i < 5; i++) t.insert(i);
         t.clear();
         t.display();
@@ -114,116 +106,7 @@ int main() {
         t.clear();
     }
 
-    // Performance test
-    {
-        /*
-         * For best performance remove if statement (risking not detecting a bug)
-         */
-        algo::ds::rbt::RBTree<int> t;
-        std::cout << std::setprecision(16) << std::fixed;
-        /*
-         * Test for 10000 elements
-         */
-        std::cout << "insert and search test for " << test1 << " elements" << "\n";
-        auto start = std::chrono::system_clock::now();
-        for (auto i = 0; i < test1; ++i) {
-            t.insert(i);
-        }
-        auto end = std::chrono::system_clock::now();
-        std::chrono::duration<double> elapsed_seconds = end - start;
-        std::cout << "Inserted " << test1 << " elements in " << elapsed_seconds.count() << "\n";
-
-        start = std::chrono::system_clock::now();
-        for (auto i = 0; i < test1; ++i) {
-            if (!t.find(i)) {
-                std::cerr << "Error during rbt::RBTree<int>::find()" << "\n";
-                break;
-            }
-        }
-        end = std::chrono::system_clock::now();
-        elapsed_seconds = end - start;
-        std::cout << "Found all of " << test1 << " elements in " << elapsed_seconds.count() << "s" << "\n" << "\n";
-        t.clear();
-
-
-        /*
-         * Test for 100000 elements
-         */
-        std::cout << "insert and search test for " << test2 << " elements" << "\n";
-        start = std::chrono::system_clock::now();
-        for (auto i = 0; i < test2; ++i) {
-            t.insert(i);
-        }
-        end = std::chrono::system_clock::now();
-        elapsed_seconds = end - start;
-        std::cout << "Inserted " << test2 << " elements in " << elapsed_seconds.count() << "\n";
-
-        start = std::chrono::system_clock::now();
-        for (auto i = 0; i < test2; ++i) {
-            if (!t.find(i)) {
-                std::cerr << "Error during rbt::RBTree<int>::find()" << "\n";
-                break;
-            }
-        }
-        end = std::chrono::system_clock::now();
-        elapsed_seconds = end - start;
-        std::cout << "Found all of " << test2 << " elements in " << elapsed_seconds.count() << "s" << "\n" << "\n";
-        t.clear();
-
-
-        /*
-         * Test for 1000000 elements
-         */
-        std::cout << "insert and search test for " << test3 << " elements" << "\n";
-        start = std::chrono::system_clock::now();
-        for (auto i = 0; i < test3; ++i) {
-            t.insert(i);
-        }
-        end = std::chrono::system_clock::now();
-        elapsed_seconds = end - start;
-        std::cout << "Inserted " << test3 << " elements in " << elapsed_seconds.count() << "\n";
-
-        start = std::chrono::system_clock::now();
-        for (auto i = 0; i < test3; ++i) {
-            if (!t.find(i)) {
-                std::cerr << "Error during rbt::RBTree<int>::find()" << "\n";
-                break;
-            }
-        }
-        end = std::chrono::system_clock::now();
-        elapsed_seconds = end - start;
-        std::cout << "Found all of " << test3 << " elements in " << elapsed_seconds.count() << "s" << "\n" << "\n";
-        t.clear();
-
-
-        /*
-         * Test for 10000000 elements
-         */
-        std::cout << "insert and search test for " << test4 << " elements" << "\n";
-        start = std::chrono::system_clock::now();
-        for (auto i = 0; i < test4; ++i) {
-            t.insert(i);
-        }
-        end = std::chrono::system_clock::now();
-        elapsed_seconds = end - start;
-        std::cout << "Inserted " << test4 << " elements in " << elapsed_seconds.count() << "\n";
-
-        start = std::chrono::system_clock::now();
-        for (auto i = 0; i < test4; ++i) {
-            if (!t.find(i)) {
-                std::cerr << "Error during rbt::RBTree<int>::find()" << "\n";
-                break;
-            }
-        }
-        end = std::chrono::system_clock::now();
-        elapsed_seconds = end - start;
-        std::cout << "Found all of " << test4 << " elements in " << elapsed_seconds.count() << "s" << "\n" << "\n";
-        t.clear();
-
-        std::cout << t.size() << "\n";
-    }
-
-    _sleep(5000);
+    // Performance is measured by benchmarks/rbt_benchmark.cpp
 
 	return 0;
 }
\ No newline at end of file
@@ -5,7 +5,7 @@
 
 #include <exception>
 
-namespace algo::ds::rbt::exception {
+namespace ads::ds::rbt::exception {
     struct NodeIndexOutOfBoundException : public std::exception {
         [[nodiscard]] const char* what() const noexcept override {
             return "Out of bound! Tried to get element at index bigger than 2 or smaller than 0!";
@@ -35,6 +35,54 @@ namespace algo::ds::rbt::exception {
             return "Tried to replace for an element that would destroy the balance of a tree.";
         }
     };
+
+    struct TreeJoinException : public std::exception {
+        [[nodiscard]] const char* what() const noexcept override {
+            return "Tried to join a tree whose keys are not all bigger than the keys of this tree.";
+        }
+    };
+
+    struct TreeBatchOrderException : public std::exception {
+        [[nodiscard]] const char* what() const noexcept override {
+            return "Tried to apply a batch whose operations are not sorted by key.";
+        }
+    };
+
+    struct TreeCapacityException : public std::exception {
+        [[nodiscard]] const char* what() const noexcept override {
+            return "The node pool is full, 32-bit indices address at most 2^32 - 1 nodes.";
+        }
+    };
+
+    struct TreeEmptyException : public std::exception {
+        [[nodiscard]] const char* what() const noexcept override {
+            return "Tried to take an element out of an empty tree.";
+        }
+    };
+
+    struct TooManyReadersException : public std::exception {
+        [[nodiscard]] const char* what() const noexcept override {
+            return "No free reader slot left in the epoch domain.";
+        }
+    };
+
+    struct TreeSnapshotException : public std::exception {
+        [[nodiscard]] const char* what() const noexcept override {
+            return "Failed to save or load a tree snapshot, the file is missing, truncated or was written for another key type.";
+        }
+    };
+
+    struct TreeMappingException : public std::exception {
+        [[nodiscard]] const char* what() const noexcept override {
+            return "Failed to write or map a tree file, the file is missing, truncated or was written for another key type.";
+        }
+    };
+
+    struct TreeJournalException : public std::exception {
+        [[nodiscard]] const char* what() const noexcept override {
+            return "Failed to append to or checkpoint the operation journal.";
+        }
+    };
 }
 
 #endif
\ No newline at end of file
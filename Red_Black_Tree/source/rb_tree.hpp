@@ -7,30 +7,68 @@
 #include "rbt_reverse_iterator.hpp"
 #include "rbt_const_iterator.hpp"
 #include "rbt_const_reverse_iterator.hpp"
+#include "rbt_balance.hpp"
+#include "rbt_fixup.hpp"
+#include "rbt_reclaimer.hpp"
+#include "rbt_serializer.hpp"
+#include "rbt_shape.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <fstream>
 #include <initializer_list>
+#include <numeric>
+#include <random>
+#include <ranges>
+#include <string>
+#include <thread>
 #include <vector>
 
 namespace ads::ds::rbt {
 
-    template <typename T>
+    template <typename T, typename Aug = ads::ds::rbt::augment::NoAugmentation, typename Stats = ads::ds::rbt::stats::NoStats, typename Balance = ads::ds::rbt::balance::RedBlack>
     class RBTree {
     public:
-        typedef T                                                key_t;
-        typedef T&                                               key_ref_t;
-        typedef ads::ds::rbt::node_impl::RBNode<T>               node_t;
-        typedef ads::ds::rbt::node_impl::RBNode<T>*              node_ptr_t;
-        typedef ads::ds::rbt::node_impl::RBNode<T>&              node_ref_t;
-        typedef ads::ds::rbt::node_impl::RBNode<T>&&             node_rval_t;
-        typedef RBTree<T>                                        self_type;
-        typedef RBTree<T>*                                       pointer_t;
-        typedef RBTree<T>&                                       reference_t;
-        typedef RBTree<T>&&                                      rvalue_t;
-        typedef ads::ds::rbt::iterators::Iterator<T>             iterator;
-        typedef ads::ds::rbt::iterators::ConstIterator<T>        const_iterator;
-        typedef ads::ds::rbt::iterators::ReverseIterator<T>      reverse_iterator;
-        typedef ads::ds::rbt::iterators::ConstReverseIterator<T> creverse_iterator;
+        typedef T                                                            key_t;
+        typedef const T&                                                     key_ref_t;
+        typedef ads::ds::rbt::node_impl::RBNode<T, Aug>                      node_t;
+        typedef ads::ds::rbt::node_impl::RBNode<T, Aug>*                     node_ptr_t;
+        typedef ads::ds::rbt::node_impl::RBNode<T, Aug>&                     node_ref_t;
+        typedef ads::ds::rbt::node_impl::RBNode<T, Aug>&&                    node_rval_t;
+        typedef Aug                                                          augment_t;
+        typedef typename Aug::value_type                                     aug_t;
+        typedef Stats                                                        stats_t;
+        typedef Balance                                                      balance_t;
+        typedef RBTree<T, Aug, Stats, Balance>                                        self_type;
+        typedef RBTree<T, Aug, Stats, Balance>*                                       pointer_t;
+        typedef RBTree<T, Aug, Stats, Balance>&                                       reference_t;
+        typedef RBTree<T, Aug, Stats, Balance>&&                                      rvalue_t;
+        typedef ads::ds::rbt::iterators::Iterator<T, Aug, Stats>             iterator;
+        typedef ads::ds::rbt::iterators::ConstIterator<T, Aug, Stats>        const_iterator;
+        typedef ads::ds::rbt::iterators::ReverseIterator<T, Aug, Stats>      reverse_iterator;
+        typedef ads::ds::rbt::iterators::ConstReverseIterator<T, Aug, Stats> creverse_iterator;
+
+        static constexpr bool augmented         = ads::ds::rbt::augment::is_augmented<Aug>;
+        static constexpr bool order_statistics  = ads::ds::rbt::augment::counts_keys<Aug>;
+        static constexpr bool merkle            = ads::ds::rbt::augment::hashes_keys<Aug>;
+        static constexpr bool red_black         = Balance::red_black;
+        static constexpr size_t batch_grain     = size_t{ 1 } << 12;    // batch entries per thread at least
+
+        // One entry of a batch for apply_batch, entries are sorted by key and equal keys apply in their order
+        enum class op_t : std::uint8_t { insert, erase };
+
+        struct batch_op_t {
+            op_t op;
+            T    key;
+        };
+
+        // Lazy view over a key range, two iterators and no copies; sized in O(log n) with order statistics
+        typedef std::ranges::subrange<const_iterator, const_iterator, (order_statistics ? std::ranges::subrange_kind::sized : std::ranges::subrange_kind::unsized)> view_t;
 
     private:
+        friend Balance;
+        friend ads::ds::rbt::balance::Ranked;
+
         /**
             * Helper functions
         */
@@ -38,12 +76,70 @@ namespace ads::ds::rbt {
         void   Display(node_ptr_t, size_t);
         void   Rotate_left(node_ptr_t);
         void   Rotate_right(node_ptr_t);
-        void   Insert_fix(node_ptr_t);
+        bool   Insert_fix(node_ptr_t);
         void   Merge(node_ptr_t);
         void   Split(node_ptr_t);
-        void   Delete_fix(node_ptr_t);
+        void   Transplant(node_ptr_t, node_ptr_t);
+        bool   Link(node_ptr_t);
+        node_ptr_t Descend(node_ptr_t, const key_ref_t, node_ptr_t&) const;
+        void   Hang(node_ptr_t, node_ptr_t);
+        node_ptr_t Climb(node_ptr_t, const key_ref_t, node_ptr_t* = nullptr) const;
+        size_t Apply_sorted(const batch_op_t*, const batch_op_t*);
+        size_t Apply_walk(const batch_op_t*, const batch_op_t*);
+        size_t Apply_merge(const batch_op_t*, const batch_op_t*);
+        void   Delete_fix(node_ptr_t, node_ptr_t);
         void   Copy(node_ptr_t);
         void   Chop(node_ptr_t);
+        size_t Black_height(node_ptr_t) const;
+        struct Shape_totals { size_t depth_sum{ 0 }; size_t links{ 0 }; size_t same_page{ 0 }; size_t measured{ 0 }; };
+        void   Shape_visit(node_ptr_t, size_t, const T*, const T*, ads::ds::rbt::ShapeReport&, Shape_totals&) const;
+        void   Shape_leaf(size_t, size_t, ads::ds::rbt::ShapeReport&) const;
+        void   Shape_finish(ads::ds::rbt::ShapeReport&, const Shape_totals&) const;
+        node_ptr_t Lower_bound(const key_ref_t x) const { return Lower_bound(root_, nullptr, x); };
+        node_ptr_t Lower_bound(node_ptr_t, node_ptr_t, const key_ref_t) const;
+        view_t     View(node_ptr_t, node_ptr_t) const;
+        node_ptr_t Upper_bound(const key_ref_t) const;
+        std::pair<node_ptr_t, size_t> Join(node_ptr_t, size_t, node_ptr_t, node_ptr_t, size_t);
+        void   Cut(node_ptr_t, size_t, const key_ref_t, std::pair<node_ptr_t, size_t>&, std::pair<node_ptr_t, size_t>&) requires red_black;
+        std::pair<node_ptr_t, size_t> Concat(std::pair<node_ptr_t, size_t>, std::pair<node_ptr_t, size_t>);
+        size_t Drop(node_ptr_t, bool);
+        size_t Count_apart(node_ptr_t) const;
+        size_t Unlink_range(node_ptr_t, node_ptr_t);
+        static size_t Free(node_ptr_t);
+        node_ptr_t Build(const T*, const T*, size_t, size_t, size_t);
+        static void Merge_runs(std::vector<T>&, std::vector<size_t>, size_t);
+        static aug_t Aggregate_of(node_ptr_t n) { return (n == nullptr ? Aug::identity() : n->aug); };
+        void   Pull(node_ptr_t);
+        void   Pull_up(node_ptr_t);
+        node_ptr_t Select(size_t) const;
+        aug_t  Aggregate_between(const T*, const T*) const;
+        void   Diff(node_ptr_t, const T*, const T*, const self_type&, std::pair<std::vector<T>, std::vector<T>>&) const;
+        static void Paint(node_ptr_t, int);
+        // Passes a key comparison through, counted as one comparison event
+        static bool Compared(bool result) { Stats::count(ads::ds::rbt::stats::comparison); return result; };
+
+        // Link access for the shared red-black fixups (rbt_fixup.hpp), rotations keep the aggregates and the stats
+        struct Links {
+            typedef node_ptr_t handle_t;
+
+            static constexpr node_ptr_t nil = nullptr;
+
+            self_type& t;
+
+            node_ptr_t root()                      const { return t.root_; };
+            node_ptr_t son(node_ptr_t n, int d)    const { return (d == 0 ? n->left : n->right); };
+            node_ptr_t father(node_ptr_t n)        const { return n->father; };
+            bool       red(node_ptr_t n)           const { return n != nullptr && n->color == ads::ds::rbt::node_impl::red; };
+            void       paint(node_ptr_t n, bool red)     { Paint(n, red ? ads::ds::rbt::node_impl::red : ads::ds::rbt::node_impl::black); };
+            void       step(ads::ds::rbt::stats::event e) { Stats::count(e); };
+
+            node_ptr_t rotate(node_ptr_t n, int d) {
+                if (d == 0) t.Rotate_left(n);
+                else t.Rotate_right(n);
+
+                return n;
+            };
+        };
 
     public:
         /**
@@ -52,25 +148,26 @@ namespace ads::ds::rbt {
         RBTree()                              : size_{ 0 }, root_{ nullptr } {};
         RBTree(const reference_t t)           : size_{ 0 }, root_{ nullptr } { Copy(t.root_); };
         RBTree(rvalue_t t) noexcept           : size_{ 0 }, root_{ nullptr } { Copy(t.root_); };
-        RBTree(std::initializer_list<T> init) : size_{ 0 } { for (auto& e : init) { insert(e); } };
+        RBTree(std::initializer_list<T> init) : size_{ 0 }, root_{ nullptr } { for (auto& e : init) { insert(e); } };
         template<typename InputIt>
-        RBTree(InputIt first, InputIt last)   : size_{ 0 } { for (auto it = first; it != last; it++) { insert(*it); } };
+        RBTree(InputIt first, InputIt last)   : size_{ 0 }, root_{ nullptr } { for (auto it = first; it != last; it++) { insert(*it); } };
+        ~RBTree()                                                              { Chop(root_); };
 
         /**
             * Utility functions
         */
         node_ptr_t                                getRoot() const { return root_; };
-        iterator                                  root() { return iterator(root_); };
-        const_iterator                            root()    const { return const_iterator(root_); };
-        const_iterator                            croot()   const { return const_iterator(root_); };
-        size_t                                    size() { return size_; };
+        iterator                                  root() { return iterator(root_, &root_); };
+        const_iterator                            root()    const { return const_iterator(root_, &root_); };
+        const_iterator                            croot()   const { return const_iterator(root_, &root_); };
+        size_t                                    size()    const { return size_; };
         [[nodiscard]] bool                        isEmpty() const { return (root_ == nullptr && size_ == 0); };
         void                                      display() { Display(root_, 0); };
         void                                      clear() { size_ = 0; Chop(root_); root_ = nullptr; };
         node_ptr_t                                maxIt()   const { return (isEmpty() ? nullptr : root_->max_node()); };
-        iterator                                  maxIter() { return iterator(maxIt()); };
+        iterator                                  maxIter() { return iterator(maxIt(), &root_); };
         node_ptr_t                                minIt()   const { return (isEmpty() ? nullptr : root_->min_node()); };
-        iterator                                  minIter() { return iterator(minIt()); };
+        iterator                                  minIter() { return iterator(minIt(), &root_); };
         iterator                                  insert(const key_ref_t);
         void                                      insert(iterator first, iterator last);
         std::pair<iterator, bool>                 insert_unique(const key_ref_t);
@@ -79,13 +176,38 @@ namespace ads::ds::rbt {
         iterator                                  iterator_to(const key_ref_t);
         const_iterator                            iterator_to(const key_ref_t) const;
         node_ptr_t                                node_find(const key_ref_t);
-        size_t                                    Black_hight();
+        node_ptr_t                                node_extract(node_ptr_t);
+        bool                                      node_link(node_ptr_t);
+        size_t                                    Black_hight() requires red_black;
+        // Counters of the Stats policy type, shared by every tree with the same Tag (see rbt_stats.hpp)
+        ads::ds::rbt::stats::Snapshot             stats()       const { return Stats::snapshot(); };
+        ads::ds::rbt::ShapeReport                 shape_report() const;
+        ads::ds::rbt::ShapeReport                 shape_report(size_t samples, std::uint64_t seed = 1) const;
+        void                                      reset_stats()       { Stats::reset(); };
+        aug_t                                     aggregate() const { return Aggregate_of(root_); };
+        aug_t                                     aggregate(const key_ref_t from, const key_ref_t to) const;
+        iterator                                  select(size_t id) requires order_statistics { return iterator(id < size_ ? Select(id) : nullptr, &root_); };
+        size_t                                    rank(const key_ref_t x) const requires order_statistics;
+        std::uint64_t                             digest() const requires merkle { return Aug::digest_of(aggregate()); };
+        std::uint64_t                             range_digest(const key_ref_t from, const key_ref_t to) const requires merkle { return Aug::digest_of(aggregate(from, to)); };
+        bool                                      same_digest(const self_type& other) const requires merkle { return size_ == other.size_ && digest() == other.digest(); };
+        std::pair<std::vector<T>, std::vector<T>> diff(const self_type& other) const requires merkle;
+        void                                      join(reference_t greater) requires red_black;
+        void                                      split(const key_ref_t x, reference_t greater) requires red_black;
+        size_t                                    apply_batch(const std::vector<batch_op_t>& ops, size_t threads = 1);
+        template<typename InputIt>
+        void                                      build_parallel(InputIt first, InputIt last, size_t threads = std::thread::hardware_concurrency());
+        void                                      build_parallel(std::vector<std::vector<T>> runs, size_t threads = std::thread::hardware_concurrency());
+        void                                      save(const std::string& path) const;
+        void                                      load(const std::string& path);
         void                                      replace(const key_ref_t, const key_ref_t);
         bool                                      remove(const key_ref_t);
         iterator                                  erase(const_iterator pos);
         iterator                                  erase(iterator pos);
         iterator                                  erase(iterator first, iterator last);
         std::size_t                               erase(const key_ref_t);
+        std::size_t                               erase_below(const key_ref_t x, bool background = false);
+        std::size_t                               erase_above(const key_ref_t x, bool background = false);
         void                                      swap(reference_t) noexcept;
         void                                      copy_from(const reference_t src);
         void                                      copy_from(rvalue_t src);
@@ -97,11 +219,18 @@ namespace ads::ds::rbt {
         const_iterator                            lower_bound(const key_ref_t x) const;
         iterator                                  upper_bound(const key_ref_t x);
         const_iterator                            upper_bound(const key_ref_t x) const;
+        iterator                                  find_from(iterator finger, const key_ref_t x);
+        const_iterator                            find_from(const_iterator finger, const key_ref_t x) const;
+        iterator                                  lower_bound_from(iterator finger, const key_ref_t x);
+        const_iterator                            lower_bound_from(const_iterator finger, const key_ref_t x) const;
+        view_t                                    range(const key_ref_t from, const key_ref_t to) const;
+        view_t                                    from(const key_ref_t x)  const { return View(Lower_bound(x), nullptr); };
+        view_t                                    until(const key_ref_t x) const { return View(minIt(), Upper_bound(x)); };
 
         /*
         * Ostream overloading
         */
-        friend std::ostream& operator<<(std::ostream& ofs, const RBTree<T>& tree) {
+        friend std::ostream& operator<<(std::ostream& ofs, const self_type& tree) {
             for (auto it = tree.cbegin(); it != tree.cend(); ++it) {
                 ofs << *it << ", ";
             }
@@ -144,16 +273,16 @@ namespace ads::ds::rbt {
             * Iterators
             * Begin/End functions
         */
-        iterator          begin()         noexcept { return iterator(minIt()); };
-        iterator          end()           noexcept { return iterator(); };
-        const_iterator    begin()   const noexcept { return const_iterator(minIt()); };
-        const_iterator    end()     const noexcept { return const_iterator(); };
+        iterator          begin()         noexcept { return iterator(minIt(), &root_); };
+        iterator          end()           noexcept { return iterator(nullptr, &root_); };
+        const_iterator    begin()   const noexcept { return const_iterator(minIt(), &root_); };
+        const_iterator    end()     const noexcept { return const_iterator(nullptr, &root_); };
         reverse_iterator  rbegin()        noexcept { return reverse_iterator(maxIt()); };
         reverse_iterator  rend()          noexcept { return reverse_iterator(); };
         creverse_iterator rbegin()  const noexcept { return creverse_iterator(maxIt()); };
         creverse_iterator rend()    const noexcept { return creverse_iterator(); };
-        const_iterator    cbegin()  const noexcept { return const_iterator(minIt()); };
-        const_iterator    cend()    const noexcept { return const_iterator(); };
+        const_iterator    cbegin()  const noexcept { return const_iterator(minIt(), &root_); };
+        const_iterator    cend()    const noexcept { return const_iterator(nullptr, &root_); };
         creverse_iterator crbegin() const noexcept { return creverse_iterator(maxIt()); };
         creverse_iterator crend()   const noexcept { return creverse_iterator(); };
 
@@ -162,8 +291,8 @@ namespace ads::ds::rbt {
         node_ptr_t root_;
     };
 
-    template <typename T>
-    inline void RBTree<T>::Copy(node_ptr_t in) {
+    template <typename T, typename Aug, typename Stats, typename Balance>
+    inline void RBTree<T, Aug, Stats, Balance>::Copy(node_ptr_t in) {
         if (in) {
             insert(in->key);
             Copy(in->left);
@@ -171,59 +300,67 @@ namespace ads::ds::rbt {
         }
     }
 
-    template <typename T>
-    inline void RBTree<T>::Chop(node_ptr_t in) {
+    template <typename T, typename Aug, typename Stats, typename Balance>
+    inline void RBTree<T, Aug, Stats, Balance>::Chop(node_ptr_t in) {
         if (in) {
             Chop(in->left);
             Chop(in->right);
 
             delete in;
+            Stats::count(ads::ds::rbt::stats::deallocation);
         }
     }
 
-    template <typename T>
-    inline typename RBTree<T>::reference_t RBTree<T>::operator=(const reference_t tree) {
+    template <typename T, typename Aug, typename Stats, typename Balance>
+    inline typename RBTree<T, Aug, Stats, Balance>::reference_t RBTree<T, Aug, Stats, Balance>::operator=(const reference_t tree) {
         if (this != &tree) {
             Chop(root_);
             root_ = nullptr;
+            size_ = 0;
             Copy(tree.root_);
         }
 
         return *this;
     }
 
-    template <typename T>
-    inline typename RBTree<T>::reference_t RBTree<T>::operator=(rvalue_t tree) noexcept {
+    template <typename T, typename Aug, typename Stats, typename Balance>
+    inline typename RBTree<T, Aug, Stats, Balance>::reference_t RBTree<T, Aug, Stats, Balance>::operator=(rvalue_t tree) noexcept {
         if (this != &tree) {
             Chop(root_);
             root_ = nullptr;
+            size_ = 0;
             Copy(tree.root_);
         }
 
         return *this;
     }
 
-    template<typename T>
-    inline bool RBTree<T>::operator==(const reference_t tree) const {
-        if (size_ != tree.size_ || root_ != tree.root_) return false;
-        else {
-            auto it = begin();
-            auto tree_it = tree.begin();
+    // Compares contents, with a Merkle augmentation differing root digests reject in O(1) and equal ones
+    // are confirmed key by key, a collision never makes two different trees equal (see same_digest())
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline bool RBTree<T, Aug, Stats, Balance>::operator==(const reference_t tree) const {
+        if (this == &tree) return true;
+        if (size_ != tree.size_) return false;
+        if constexpr (merkle) {
+            if (digest() != tree.digest()) return false;
+        }
 
-            while (it != end() && tree_it != tree.end()) {
-                if (*it != *tree_it) return false;
-                else {
-                    ++it;
-                    ++tree_it;
-                }
-            }
+        auto it = begin();
+        auto tree_it = tree.begin();
 
-            return true;
+        while (it != end() && tree_it != tree.end()) {
+            if (*it != *tree_it) return false;
+            else {
+                ++it;
+                ++tree_it;
+            }
         }
+
+        return true;
     }
 
-    template<typename T>
-    inline bool RBTree<T>::operator<(const reference_t tree) const {
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline bool RBTree<T, Aug, Stats, Balance>::operator<(const reference_t tree) const {
         if (size_ == tree.size_ && root_ < tree.root_) {
             auto it = begin();
             auto tree_it = tree.begin();
@@ -243,9 +380,10 @@ namespace ads::ds::rbt {
         }
     }
 
-    template<typename T>
-    inline T RBTree<T>::operator[](const size_t& id) {
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline T RBTree<T, Aug, Stats, Balance>::operator[](const size_t& id) {
         if (id < 0 || id >= size_) throw ads::ds::rbt::exception::TreeIndexOutOfBoundException();
+        else if constexpr (order_statistics) return Select(id)->key;
         else {
             if (id == 0) return minIt()->key;
 
@@ -258,9 +396,10 @@ namespace ads::ds::rbt {
         }
     }
 
-    template<typename T>
-    inline const T RBTree<T>::operator[](const size_t& id) const {
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline const T RBTree<T, Aug, Stats, Balance>::operator[](const size_t& id) const {
         if (id < 0 || id >= size_) throw ads::ds::rbt::exception::TreeIndexOutOfBoundException();
+        else if constexpr (order_statistics) return Select(id)->key;
         else {
             if (id == 0) return minIt()->key;
 
@@ -273,93 +412,247 @@ namespace ads::ds::rbt {
         }
     }
 
-    template <typename T>
-    inline typename RBTree<T>::iterator RBTree<T>::insert(const key_ref_t input) {
-        node_ptr_t q;
-        auto* create = new ads::ds::rbt::node_impl::RBNode<T>(input);
-        auto p = root_;
-        q = nullptr;
+    template <typename T, typename Aug, typename Stats, typename Balance>
+    inline typename RBTree<T, Aug, Stats, Balance>::iterator RBTree<T, Aug, Stats, Balance>::insert(const key_ref_t input) {
+        auto* create = new node_t(input);
+        Stats::count(ads::ds::rbt::stats::allocation);
 
-        if (root_ == nullptr) {
-            root_ = create;
-            create->father = nullptr;
+        if (!Link(create)) {
+            delete create;
+            Stats::count(ads::ds::rbt::stats::deallocation);
+
+            return end();
         }
-        else {
-            while (p != nullptr) {
-                q = p;
 
-                if (p->key > create->key) p = p->left;
-                else if (p->key < create->key) p = p->right;
-                else return end();
-            }
+        return iterator(create, &root_);
+    }
+
+    template <typename T, typename Aug, typename Stats, typename Balance>
+    inline bool RBTree<T, Aug, Stats, Balance>::node_link(node_ptr_t create) {
+        create->father = nullptr;
+        create->left = nullptr;
+        create->right = nullptr;
+        create->color = Balance::leaf;
+
+        return Link(create);
+    }
+
+    // Hangs a detached node under its in-order position and rebalances, nothing is allocated here
+    template <typename T, typename Aug, typename Stats, typename Balance>
+    inline bool RBTree<T, Aug, Stats, Balance>::Link(node_ptr_t create) {
+        node_ptr_t q = nullptr;
+
+        if (root_ != nullptr && Descend(root_, create->key, q) != nullptr) return false;
+
+        Hang(create, q);
+
+        return true;
+    }
 
-            create->father = q;
+    // Searches x below p, returns its node or nullptr with q set to the last node visited (the father-to-be of x)
+    template <typename T, typename Aug, typename Stats, typename Balance>
+    inline typename RBTree<T, Aug, Stats, Balance>::node_ptr_t RBTree<T, Aug, Stats, Balance>::Descend(node_ptr_t p, const key_ref_t x, node_ptr_t& q) const {
+        Stats::count(ads::ds::rbt::stats::descent);
 
-            if (q->key < create->key) q->right = create;
-            else if (q->key > create->key) q->left = create;
-            else return end();
+        while (p != nullptr) {
+            q = p;
+
+            if (Compared(p->key > x)) p = p->left;
+            else if (Compared(p->key < x)) p = p->right;
+            else return p;
         }
 
+        return nullptr;
+    }
+
+    // Hangs a new red leaf under q (as the root when q is nullptr) and rebalances
+    template <typename T, typename Aug, typename Stats, typename Balance>
+    inline void RBTree<T, Aug, Stats, Balance>::Hang(node_ptr_t create, node_ptr_t q) {
+        create->father = q;
+
+        if (q == nullptr) root_ = create;
+        else if (q->key < create->key) q->right = create;
+        else q->left = create;
+
         size_++;
-        Insert_fix(create);
+        Pull_up(create);
+        Balance::insert_fix(*this, create);
+    }
+
+    // Returns true when the root had to be repainted black, i.e. the black height of the tree grew
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline bool RBTree<T, Aug, Stats, Balance>::Insert_fix(node_ptr_t create) {
+        Links links{ *this };
 
-        return iterator_to(input);
+        return ads::ds::rbt::fixup::insert_fix(links, create);
     }
 
-    template<typename T>
-    inline void RBTree<T>::Insert_fix(node_ptr_t create) {
-        auto* x = create;
+    // Only actual color changes are counted as recolorings
+    template <typename T, typename Aug, typename Stats, typename Balance>
+    inline void RBTree<T, Aug, Stats, Balance>::Paint(node_ptr_t n, int color) {
+        if constexpr (Stats::enabled) {
+            if (n->color != color) Stats::count(ads::ds::rbt::stats::recolor);
+        }
 
-        while (x != root_ && x->father->color == ads::ds::rbt::node_impl::red) {
-            if (x->father == x->father->father->left) {
-                auto* y = x->father->father->right;
+        n->color = color;
+    }
 
-                if ((y != nullptr) && (y->color == ads::ds::rbt::node_impl::red)) {
-                    x->father->color = ads::ds::rbt::node_impl::black;
-                    y->color = ads::ds::rbt::node_impl::black;
-                    x->father->father->color = ads::ds::rbt::node_impl::red;
-                    x = x->father->father;
-                }
-                else {
-                    if (x->father->right == x) {
-                        x = x->father;
-                        Rotate_left(x);
-                    }
+    // Recomputes the aggregate of one node from its sons, a no-op without augmentation
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline void RBTree<T, Aug, Stats, Balance>::Pull(node_ptr_t n) {
+        if constexpr (augmented) {
+            n->aug = Aug::combine(Aug::combine(Aggregate_of(n->left), Aug::lift(n->key)), Aggregate_of(n->right));
+        }
+    }
 
-                    x->father->color = ads::ds::rbt::node_impl::black;
-                    x->father->father->color = ads::ds::rbt::node_impl::red;
-                    Rotate_right(x->father->father);
-                }
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline void RBTree<T, Aug, Stats, Balance>::Pull_up(node_ptr_t n) {
+        if constexpr (augmented) {
+            for (; n != nullptr; n = n->father) Pull(n);
+        }
+    }
+
+    // Aggregate of the keys in [from, to], in key order. Below the node where the two bounds part, every
+    // step down adds one key and one whole subtree aggregate, so the cost is O(log n).
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline typename RBTree<T, Aug, Stats, Balance>::aug_t RBTree<T, Aug, Stats, Balance>::aggregate(const key_ref_t from, const key_ref_t to) const {
+        auto* n = root_;
+
+        if (to < from) return Aug::identity();
+
+        while (n != nullptr && (n->key < from || to < n->key)) n = (n->key < from ? n->right : n->left);
+
+        if (n == nullptr) return Aug::identity();
+
+        auto lower = Aug::identity();
+        auto upper = Aug::identity();
+
+        for (auto* t = n->left; t != nullptr;) {
+            if (t->key < from) t = t->right;
+            else {
+                lower = Aug::combine(Aug::combine(Aug::lift(t->key), Aggregate_of(t->right)), lower);
+                t = t->left;
+            }
+        }
+
+        for (auto* t = n->right; t != nullptr;) {
+            if (to < t->key) t = t->left;
+            else {
+                upper = Aug::combine(upper, Aug::combine(Aggregate_of(t->left), Aug::lift(t->key)));
+                t = t->right;
             }
+        }
+
+        return Aug::combine(Aug::combine(lower, Aug::lift(n->key)), upper);
+    }
+
+    // Aggregate of the keys strictly between *lo and *hi, a null bound is open, O(log n)
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline typename RBTree<T, Aug, Stats, Balance>::aug_t RBTree<T, Aug, Stats, Balance>::Aggregate_between(const T* lo, const T* hi) const {
+        auto above = [lo](const T& k) { return lo == nullptr || *lo < k; };
+        auto below = [hi](const T& k) { return hi == nullptr || k < *hi; };
+        auto* n = root_;
+
+        while (n != nullptr && !(above(n->key) && below(n->key))) n = (above(n->key) ? n->left : n->right);
+
+        if (n == nullptr) return Aug::identity();
+
+        auto lower = Aug::identity();
+        auto upper = Aug::identity();
+
+        for (auto* t = n->left; t != nullptr;) {
+            if (!above(t->key)) t = t->right;
             else {
-                auto* y = x->father->father->left;
+                lower = Aug::combine(Aug::combine(Aug::lift(t->key), Aggregate_of(t->right)), lower);
+                t = t->left;
+            }
+        }
 
-                if ((y != nullptr) && (y->color == ads::ds::rbt::node_impl::red)) {
-                    x->father->color = ads::ds::rbt::node_impl::black;
-                    y->color = ads::ds::rbt::node_impl::black;
-                    x->father->father->color = ads::ds::rbt::node_impl::red;
-                    x = x->father->father;
-                }
-                else {
-                    if (x->father->left == x) {
-                        x = x->father;
-                        Rotate_right(x);
-                    }
+        for (auto* t = n->right; t != nullptr;) {
+            if (!below(t->key)) t = t->left;
+            else {
+                upper = Aug::combine(upper, Aug::combine(Aggregate_of(t->left), Aug::lift(t->key)));
+                t = t->right;
+            }
+        }
 
-                    x->father->color = ads::ds::rbt::node_impl::black;
-                    x->father->father->color = ads::ds::rbt::node_impl::red;
-                    Rotate_left(x->father->father);
-                }
+        return Aug::combine(Aug::combine(lower, Aug::lift(n->key)), upper);
+    }
+
+    // Subtree n of this tree holds exactly its keys between lo and hi, so its stored digest is compared
+    // with the digest of the same key range of the other tree. Equal ranges are skipped whole, only the
+    // O(log n) subtrees above every differing key are opened.
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline void RBTree<T, Aug, Stats, Balance>::Diff(node_ptr_t n, const T* lo, const T* hi, const self_type& other, std::pair<std::vector<T>, std::vector<T>>& out) const {
+        if (Aug::digest_of(Aggregate_of(n)) == Aug::digest_of(other.Aggregate_between(lo, hi))) return;
+
+        if (n == nullptr) {
+            auto* t = (lo == nullptr ? (other.root_ == nullptr ? nullptr : other.root_->min_node()) : other.Upper_bound(*lo));
+
+            for (; t != nullptr && (hi == nullptr || t->key < *hi); t = t->node_Successor()) out.second.push_back(t->key);
+
+            return;
+        }
+
+        Diff(n->left, lo, &n->key, other, out);
+
+        auto* match = other.Lower_bound(n->key);
+
+        if (match == nullptr || n->key < match->key) out.first.push_back(n->key);
+
+        Diff(n->right, &n->key, hi, other, out);
+    }
+
+    // Keys only in this tree and keys only in the other one, both ascending, O(d log^2 n) for d differences
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline std::pair<std::vector<T>, std::vector<T>> RBTree<T, Aug, Stats, Balance>::diff(const self_type& other) const requires merkle {
+        std::pair<std::vector<T>, std::vector<T>> out;
+
+        Diff(root_, nullptr, nullptr, other, out);
+
+        return out;
+    }
+
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline typename RBTree<T, Aug, Stats, Balance>::node_ptr_t RBTree<T, Aug, Stats, Balance>::Select(size_t id) const {
+        auto* n = root_;
+
+        while (n != nullptr) {
+            auto left = Aug::size_of(Aggregate_of(n->left));
+
+            if (id < left) n = n->left;
+            else if (id == left) return n;
+            else {
+                id -= left + 1;
+                n = n->right;
+            }
+        }
+
+        return nullptr;
+    }
+
+    // Number of keys smaller than x
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline size_t RBTree<T, Aug, Stats, Balance>::rank(const key_ref_t x) const requires order_statistics {
+        size_t smaller = 0;
+
+        for (auto* n = root_; n != nullptr;) {
+            if (n->key < x) {
+                smaller += Aug::size_of(Aggregate_of(n->left)) + 1;
+                n = n->right;
             }
+            else n = n->left;
         }
 
-        root_->color = ads::ds::rbt::node_impl::black;
+        return smaller;
     }
 
-    template<typename T>
-    inline void RBTree<T>::Rotate_right(node_ptr_t in) {
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline void RBTree<T, Aug, Stats, Balance>::Rotate_right(node_ptr_t in) {
         if (in->left == nullptr) return;
         else {
+            Stats::count(ads::ds::rbt::stats::rotation);
+
             auto* x = in->left;
             auto* b = x->right;
             auto* f = in->father;
@@ -380,13 +673,18 @@ namespace ads::ds::rbt {
             in->left = b;
 
             if (b != nullptr) b->father = in;
+
+            Pull(in);
+            Pull(x);
         }
     }
 
-    template <typename T>
-    inline void RBTree<T>::Rotate_left(node_ptr_t x) {
+    template <typename T, typename Aug, typename Stats, typename Balance>
+    inline void RBTree<T, Aug, Stats, Balance>::Rotate_left(node_ptr_t x) {
         if (x->right == nullptr) return;
         else {
+            Stats::count(ads::ds::rbt::stats::rotation);
+
             auto* y = x->right;
             auto* b = y->left;
             auto* f = x->father;
@@ -407,47 +705,54 @@ namespace ads::ds::rbt {
             x->right = b;
 
             if (b != nullptr) b->father = x;
+
+            Pull(x);
+            Pull(y);
         }
     }
 
-    template <typename T>
-    inline bool RBTree<T>::find(const key_ref_t in) {
+    template <typename T, typename Aug, typename Stats, typename Balance>
+    inline bool RBTree<T, Aug, Stats, Balance>::find(const key_ref_t in) {
         auto* t = root_;
 
+        Stats::count(ads::ds::rbt::stats::descent);
+
         while (t != nullptr) {
-            if (t->key == in) return true;
-            if (in > t->key) t = t->right;
-            else if (in < t->key) t = t->left;
+            if (Compared(t->key == in)) return true;
+            if (Compared(in > t->key)) t = t->right;
+            else if (Compared(in < t->key)) t = t->left;
         }
 
         return false;
     }
 
-    template <typename T>
-    inline typename RBTree<T>::iterator RBTree<T>::iterator_to(const key_ref_t x) {
-        return iterator(node_find(x));
+    template <typename T, typename Aug, typename Stats, typename Balance>
+    inline typename RBTree<T, Aug, Stats, Balance>::iterator RBTree<T, Aug, Stats, Balance>::iterator_to(const key_ref_t x) {
+        return iterator(node_find(x), &root_);
     }
 
-    template <typename T>
-    inline typename RBTree<T>::const_iterator RBTree<T>::iterator_to(const key_ref_t x) const {
-        return const_iterator(node_find(x));
+    template <typename T, typename Aug, typename Stats, typename Balance>
+    inline typename RBTree<T, Aug, Stats, Balance>::const_iterator RBTree<T, Aug, Stats, Balance>::iterator_to(const key_ref_t x) const {
+        return const_iterator(node_find(x), &root_);
     }
 
-    template<typename T>
-    typename RBTree<T>::node_ptr_t RBTree<T>::node_find(const key_ref_t in) {
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    typename RBTree<T, Aug, Stats, Balance>::node_ptr_t RBTree<T, Aug, Stats, Balance>::node_find(const key_ref_t in) {
         auto* t = root_;
 
+        Stats::count(ads::ds::rbt::stats::descent);
+
         while (t != nullptr) {
-            if (t->key == in) return t;
-            if (in > t->key) t = t->right;
-            else if (in < t->key) t = t->left;
+            if (Compared(t->key == in)) return t;
+            if (Compared(in > t->key)) t = t->right;
+            else if (Compared(in < t->key)) t = t->left;
         }
 
         return nullptr;
     }
 
-    template<typename T>
-    inline void RBTree<T>::Merge(node_ptr_t p) {
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline void RBTree<T, Aug, Stats, Balance>::Merge(node_ptr_t p) {
         if (p != nullptr) {
             if (p->left) Merge(p->left);
             if (p->right) Merge(p->right);
@@ -456,8 +761,8 @@ namespace ads::ds::rbt {
         }
     }
 
-    template<typename T>
-    inline void RBTree<T>::Split(node_ptr_t p) {
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline void RBTree<T, Aug, Stats, Balance>::Split(node_ptr_t p) {
         if (p != nullptr) {
             if (p->left) Split(p->left);
             if (p->right) Split(p->right);
@@ -466,8 +771,8 @@ namespace ads::ds::rbt {
         }
     }
 
-    template<typename T>
-    inline size_t RBTree<T>::Black_hight() {
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline size_t RBTree<T, Aug, Stats, Balance>::Black_hight() requires red_black {
         auto* p = root_;
         auto num = 0;
 
@@ -480,155 +785,853 @@ namespace ads::ds::rbt {
         return num;
     }
 
-    template<typename T>
-    inline size_t RBTree<T>::Size(node_ptr_t in) {
-        if (in == nullptr) return 0;
+    // Sorts the input on up to threads cores, drops duplicates and builds the tree bottom-up without rebalancing
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    template<typename InputIt>
+    inline void RBTree<T, Aug, Stats, Balance>::build_parallel(InputIt first, InputIt last, size_t threads) {
+        std::vector<T> keys(first, last);
+        std::vector<size_t> runs;
+
+        threads = std::max<size_t>(threads, 1);
+
+        auto chunk = (keys.size() + threads - 1) / threads;
+        std::vector<std::thread> workers;
+
+        for (size_t lo = 0; lo < keys.size(); lo += chunk) {
+            auto hi = std::min(keys.size(), lo + chunk);
+            runs.push_back(lo);
+            workers.emplace_back([&keys, lo, hi] { std::sort(keys.begin() + lo, keys.begin() + hi); });
+        }
+
+        for (auto& w : workers) w.join();
+
+        runs.push_back(keys.size());
+        Merge_runs(keys, std::move(runs), threads);
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+        clear();
+        size_ = keys.size();
+        root_ = Build(keys.data(), keys.data() + keys.size(), 0, std::bit_width(keys.size()), threads);
+    }
+
+    // Same as above for input already partitioned into sorted runs, only the merging is left
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline void RBTree<T, Aug, Stats, Balance>::build_parallel(std::vector<std::vector<T>> runs, size_t threads) {
+        std::vector<T> keys;
+        std::vector<size_t> bounds;
+
+        for (auto& run : runs) {
+            bounds.push_back(keys.size());
+            keys.insert(keys.end(), run.begin(), run.end());
+            run.clear();
+            run.shrink_to_fit();
+        }
+
+        bounds.push_back(keys.size());
+        Merge_runs(keys, std::move(bounds), std::max<size_t>(threads, 1));
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+        clear();
+        size_ = keys.size();
+        root_ = Build(keys.data(), keys.data() + keys.size(), 0, std::bit_width(keys.size()), std::max<size_t>(threads, 1));
+    }
+
+    // Merges neighbouring sorted runs pairwise, every round merges its pairs in parallel
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline void RBTree<T, Aug, Stats, Balance>::Merge_runs(std::vector<T>& keys, std::vector<size_t> bounds, size_t threads) {
+        while (bounds.size() > 2) {
+            std::vector<size_t> next;
+            std::vector<std::thread> workers;
+
+            for (size_t i = 0; i + 2 < bounds.size(); i += 2) {
+                auto lo = bounds[i];
+                auto mid = bounds[i + 1];
+                auto hi = bounds[i + 2];
+                auto merge = [&keys, lo, mid, hi] { std::inplace_merge(keys.begin() + lo, keys.begin() + mid, keys.begin() + hi); };
+
+                if (workers.size() + 1 < threads) workers.emplace_back(merge);
+                else merge();
+
+                next.push_back(lo);
+            }
+
+            for (auto& w : workers) w.join();
+
+            if (bounds.size() % 2 == 0) next.push_back(bounds[bounds.size() - 2]);
+
+            next.push_back(bounds.back());
+            bounds = std::move(next);
+        }
+    }
+
+    // Builds the subtree of sorted unique keys [lo, hi) whose root lies at the given depth. Splitting at the
+    // middle fills every level but the deepest one, painting only that level red keeps every path equally black.
+    // Both halves of the top levels are built on separate threads, so every worker allocates its own nodes.
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline typename RBTree<T, Aug, Stats, Balance>::node_ptr_t RBTree<T, Aug, Stats, Balance>::Build(const T* lo, const T* hi, size_t depth, size_t levels, size_t threads) {
+        if (lo == hi) return nullptr;
+
+        auto* mid = lo + (hi - lo) / 2;
+        auto* create = new node_t(*mid);
+        Stats::count(ads::ds::rbt::stats::allocation);
+        node_ptr_t left = nullptr;
+
+        if constexpr (red_black) create->color = (levels > 1 && depth + 1 == levels ? ads::ds::rbt::node_impl::red : ads::ds::rbt::node_impl::black);
+
+        if (threads > 1) {
+            std::thread worker([&] { left = Build(lo, mid, depth + 1, levels, threads / 2); });
+            create->right = Build(mid + 1, hi, depth + 1, levels, threads - threads / 2);
+            worker.join();
+        }
         else {
-            auto ls = Size(in->left);
-            auto rs = Size(in->right);
+            left = Build(lo, mid, depth + 1, levels, 1);
+            create->right = Build(mid + 1, hi, depth + 1, levels, 1);
+        }
 
-            return (ls + rs + 1);
+        create->left = left;
+
+        if (create->left != nullptr) create->left->father = create;
+        if (create->right != nullptr) create->right->father = create;
+
+        // Ranks are heights - 1, the halves differ by one key at most so their heights by one at most
+        if constexpr (!red_black) create->color = std::max(Balance::rank_of(create->left), Balance::rank_of(create->right)) + 1;
+
+        Pull(create);
+
+        return create;
+    }
+
+    // Writes a binary snapshot, trivially copyable keys go out in blocks of consecutive keys
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline void RBTree<T, Aug, Stats, Balance>::save(const std::string& path) const {
+        namespace ser = ads::ds::rbt::serialization;
+
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+
+        if (!out) throw ads::ds::rbt::exception::TreeSnapshotException();
+
+        ser::SnapshotHeader header{ ser::snapshot_magic, ser::snapshot_version, 0, 0, static_cast<std::uint64_t>(size_) };
+
+        if constexpr (ser::raw_serializable<T>) header.key_bytes = sizeof(T);
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        if constexpr (ser::raw_serializable<T>) {
+            constexpr size_t block = (size_t{ 1 } << 16) / sizeof(T) + 1;
+            std::vector<T> buffer;
+            buffer.reserve(block);
+
+            for (auto it = cbegin(); it != cend(); ++it) {
+                buffer.push_back(*it);
+
+                if (buffer.size() == block) {
+                    out.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size() * sizeof(T)));
+                    buffer.clear();
+                }
+            }
+
+            out.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size() * sizeof(T)));
         }
+        else {
+            for (auto it = cbegin(); it != cend(); ++it) ser::Serializer<T>::write(out, *it);
+        }
+
+        if (!out.flush()) throw ads::ds::rbt::exception::TreeSnapshotException();
     }
 
-    template<typename T>
-    inline void RBTree<T>::Display(node_ptr_t in, size_t level) {
-        if (in == nullptr) return;
+    // Replaces the content with a snapshot: one sequential read, then the bottom-up Build, no rebalancing
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline void RBTree<T, Aug, Stats, Balance>::load(const std::string& path) {
+        namespace ser = ads::ds::rbt::serialization;
 
-        std::cout << "level: " << level << std::endl;
-        std::cout << in;
+        std::ifstream in(path, std::ios::binary);
+        ser::SnapshotHeader header{};
 
-        Display(in->left, level + 1);
-        Display(in->right, level + 1);
+        if (!in || !in.read(reinterpret_cast<char*>(&header), sizeof(header))) throw ads::ds::rbt::exception::TreeSnapshotException();
+        if (header.magic != ser::snapshot_magic || header.version != ser::snapshot_version) throw ads::ds::rbt::exception::TreeSnapshotException();
+
+        // The size comes from the file, it is checked against the bytes actually there before allocating
+        std::vector<T> keys;
+        auto left = ser::remaining(in);
+
+        if constexpr (ser::raw_serializable<T>) {
+            if (header.key_bytes != sizeof(T) || header.size > left / sizeof(T)) throw ads::ds::rbt::exception::TreeSnapshotException();
+
+            keys.resize(static_cast<size_t>(header.size));
+
+            if (!in.read(reinterpret_cast<char*>(keys.data()), static_cast<std::streamsize>(keys.size() * sizeof(T)))) throw ads::ds::rbt::exception::TreeSnapshotException();
+        }
+        else {
+            if (header.key_bytes != 0) throw ads::ds::rbt::exception::TreeSnapshotException();
+
+            // A key takes at least one byte with any sensible Serializer, more keys than that only grow the vector
+            keys.reserve(static_cast<size_t>(std::min(header.size, left)));
+
+            for (std::uint64_t i = 0; i < header.size; ++i) keys.push_back(ser::Serializer<T>::read(in));
+        }
+
+        // Build trusts the order, a damaged file must not turn into a broken tree
+        for (size_t i = 1; i < keys.size(); ++i) {
+            if (!(keys[i - 1] < keys[i])) throw ads::ds::rbt::exception::TreeSnapshotException();
+        }
+
+        clear();
+        size_ = keys.size();
+        root_ = Build(keys.data(), keys.data() + keys.size(), 0, std::bit_width(keys.size()), 1);
     }
 
-    template <typename T>
-    inline bool RBTree<T>::remove(const key_ref_t x) {
-        if (root_ == nullptr) {
-            std::cout << "\nEmpty RBTree.";
+    // Checks and measures one node, depth counts edges from the root
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline void RBTree<T, Aug, Stats, Balance>::Shape_visit(node_ptr_t n, size_t depth, const T* lo, const T* hi, ads::ds::rbt::ShapeReport& r, Shape_totals& totals) const {
+        if (r.depth_histogram.size() <= depth) r.depth_histogram.resize(depth + 1, 0);
+        if (!r.sampled) r.depth_histogram[depth]++;
 
-            return false;
+        r.max_depth = std::max(r.max_depth, depth);
+        totals.depth_sum += depth;
+        totals.measured++;
+        r.allocated_bytes += ads::ds::rbt::detail::usable_size(n, sizeof(node_t));
+
+        if (n->father != nullptr) {
+            totals.links++;
+
+            if (ads::ds::rbt::detail::same_page(n, n->father)) totals.same_page++;
+            if constexpr (red_black) {
+                if (n->color == ads::ds::rbt::node_impl::red && n->father->color == ads::ds::rbt::node_impl::red) r.red_red_violations++;
+            }
         }
+        if constexpr (!red_black) {
+            if (!Balance::valid(n)) r.rank_violations++;
+        }
+        if ((lo != nullptr && !(*lo < n->key)) || (hi != nullptr && !(n->key < *hi))) r.order_violations++;
+        if ((n->left != nullptr && n->left->father != n) || (n->right != nullptr && n->right->father != n)) r.father_link_violations++;
+    }
 
-        auto* p = root_;
-        auto found = 0;
+    // A missing son ends a root to leaf path, every path has to meet the same number of black nodes
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline void RBTree<T, Aug, Stats, Balance>::Shape_leaf(size_t depth, size_t blacks, ads::ds::rbt::ShapeReport& r) const {
+        if constexpr (red_black) {
+            if (r.paths == 0) r.black_height = blacks;
+            else if (blacks != r.black_height) r.black_height_violations++;
+        }
+
+        r.paths++;
+
+        if (r.sampled) r.depth_histogram[depth]++;
+
+        r.height = std::max(r.height, depth + 1);
+    }
+
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline void RBTree<T, Aug, Stats, Balance>::Shape_finish(ads::ds::rbt::ShapeReport& r, const Shape_totals& totals) const {
+        r.nodes = size_;
+        r.height_bound = Balance::height_bound(size_);
+        r.average_depth = (totals.measured == 0 ? 0.0 : static_cast<double>(totals.depth_sum) / static_cast<double>(totals.measured));
+        r.same_page_links = (totals.links == 0 ? 0.0 : static_cast<double>(totals.same_page) / static_cast<double>(totals.links));
+
+        // Sampled nodes stand for all of them
+        if (r.sampled && totals.measured != 0) r.allocated_bytes = r.allocated_bytes / totals.measured * size_;
+
+        r.node_bytes = sizeof(node_t) * size_;
+        r.payload_bytes = sizeof(T) * size_;
+        r.overhead_ratio = (r.payload_bytes == 0 ? 0.0 : static_cast<double>(r.allocated_bytes) / static_cast<double>(r.payload_bytes));
+        r.allocator_slack = (r.allocated_bytes == 0 ? 0.0 : 1.0 - static_cast<double>(r.node_bytes) / static_cast<double>(r.allocated_bytes));
+        if constexpr (red_black) r.red_root = (root_ != nullptr && root_->color == ads::ds::rbt::node_impl::red ? 1 : 0);
+
+        r.valid = (r.red_root + r.red_red_violations + r.black_height_violations + r.rank_violations + r.order_violations + r.father_link_violations == 0);
+    }
+
+    // Visits every node once, O(n) time and O(height) stack
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline ads::ds::rbt::ShapeReport RBTree<T, Aug, Stats, Balance>::shape_report() const {
+        struct Frame {
+            node_ptr_t n;
+            size_t     depth;
+            size_t     blacks;
+            const T*   lo;
+            const T*   hi;
+        };
+
+        ads::ds::rbt::ShapeReport r;
+        Shape_totals totals;
+        std::vector<Frame> stack;
+
+        if (root_ != nullptr) stack.push_back({ root_, 0, 0, nullptr, nullptr });
+
+        while (!stack.empty()) {
+            auto f = stack.back();
+            stack.pop_back();
+
+            auto blacks = f.blacks + (f.n->color == ads::ds::rbt::node_impl::black ? 1 : 0);
+            Shape_visit(f.n, f.depth, f.lo, f.hi, r, totals);
+
+            if (f.n->left != nullptr) stack.push_back({ f.n->left, f.depth + 1, blacks, f.lo, &f.n->key });
+            else Shape_leaf(f.depth, blacks, r);
+
+            if (f.n->right != nullptr) stack.push_back({ f.n->right, f.depth + 1, blacks, &f.n->key, f.hi });
+            else Shape_leaf(f.depth, blacks, r);
+        }
+
+        Shape_finish(r, totals);
+
+        return r;
+    }
+
+    // Walks samples random root to leaf paths, every step picks either son slot with equal chance,
+    // O(samples * log n) whatever the size of the tree
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline ads::ds::rbt::ShapeReport RBTree<T, Aug, Stats, Balance>::shape_report(size_t samples, std::uint64_t seed) const {
+        ads::ds::rbt::ShapeReport r;
+        Shape_totals totals;
+        std::mt19937_64 gen(seed);
+
+        r.sampled = true;
 
-        while (p != nullptr && found == 0) {
-            if (p->key == x) found = 1;
-            if (found == 0) {
-                if (p->key < x) p = p->right;
-                else p = p->left;
+        for (size_t s = 0; s < samples && root_ != nullptr; ++s) {
+            auto* n = root_;
+            size_t depth = 0;
+            size_t blacks = 0;
+            const T* lo = nullptr;
+            const T* hi = nullptr;
+
+            for (;;) {
+                blacks += (n->color == ads::ds::rbt::node_impl::black ? 1 : 0);
+                Shape_visit(n, depth, lo, hi, r, totals);
+
+                auto go_left = ((gen() & 1) == 0);
+                auto* next = (go_left ? n->left : n->right);
+
+                if (next == nullptr) {
+                    Shape_leaf(depth, blacks, r);
+                    break;
+                }
+
+                (go_left ? hi : lo) = &n->key;
+                n = next;
+                depth++;
             }
         }
 
-        if (found == 0) return false;
+        Shape_finish(r, totals);
+
+        return r;
+    }
+
+    // Black nodes on any path from the node down to a leaf, the node itself included
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline size_t RBTree<T, Aug, Stats, Balance>::Black_height(node_ptr_t p) const {
+        size_t num = 0;
+
+        while (p != nullptr) {
+            if (p->color == ads::ds::rbt::node_impl::black) num++;
+
+            p = p->left;
+        }
+
+        return num;
+    }
+
+    // Links l < k < r into one tree, l and r are black rooted with black heights lh and rh.
+    // Walks down the spine of the higher tree only, so the cost is O(|lh - rh| + 1).
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline std::pair<typename RBTree<T, Aug, Stats, Balance>::node_ptr_t, size_t> RBTree<T, Aug, Stats, Balance>::Join(node_ptr_t l, size_t lh, node_ptr_t k, node_ptr_t r, size_t rh) {
+        k->father = nullptr;
+
+        if (lh == rh) {
+            k->left = l;
+            k->right = r;
+            k->color = ads::ds::rbt::node_impl::black;
+
+            if (l != nullptr) l->father = k;
+            if (r != nullptr) r->father = k;
+
+            Pull(k);
+
+            return { k, lh + 1 };
+        }
+
+        auto* high = (lh > rh ? l : r);
+        auto* p = high;
+        node_ptr_t q = nullptr;
+        auto h = (lh > rh ? lh : rh);
+        auto low = (lh > rh ? rh : lh);
+
+        while (p != nullptr && !(p->color == ads::ds::rbt::node_impl::black && h == low)) {
+            if (p->color == ads::ds::rbt::node_impl::black) h--;
+
+            q = p;
+            p = (lh > rh ? p->right : p->left);
+        }
+
+        k->color = ads::ds::rbt::node_impl::red;
+        k->father = q;
+
+        if (lh > rh) {
+            k->left = p;
+            k->right = r;
+            q->right = k;
+        }
         else {
-            //std::cout << "Deleted Element: " << p->key << " Colour: " << (p->color == black ? "Black" : "Red" ) << "   SIZE: " << size_-1 << std::endl;
+            k->left = l;
+            k->right = p;
+            q->left = k;
+        }
 
-            node_ptr_t y = nullptr;
-            node_ptr_t q = nullptr;
+        if (k->left != nullptr) k->left->father = k;
+        if (k->right != nullptr) k->right->father = k;
 
-            if (p->left == nullptr || p->right == nullptr) y = p;
-            else y = p->node_Successor();
+        root_ = high;
+        high->father = nullptr;
+        Pull_up(k);
+        auto grew = Insert_fix(k);
 
-            if (y->left != nullptr) q = y->left;
-            else {
-                if (y->right != nullptr) q = y->right;
-                else q = nullptr;
+        return { root_, (lh > rh ? lh : rh) + (grew ? 1 : 0) };
+    }
+
+    // Cuts the subtree t (black height th) into keys < x and keys >= x, both black rooted
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline void RBTree<T, Aug, Stats, Balance>::Cut(node_ptr_t t, size_t th, const key_ref_t x, std::pair<node_ptr_t, size_t>& lo, std::pair<node_ptr_t, size_t>& hi) requires red_black {
+        if (t == nullptr) {
+            lo = { nullptr, 0 };
+            hi = { nullptr, 0 };
+
+            return;
+        }
+
+        auto sons_h = th - (t->color == ads::ds::rbt::node_impl::black ? 1 : 0);
+        std::pair<node_ptr_t, size_t> left{ t->left, sons_h };
+        std::pair<node_ptr_t, size_t> right{ t->right, sons_h };
+
+        for (auto* side : { &left, &right }) {
+            if (side->first != nullptr) {
+                side->first->father = nullptr;
+
+                if (side->first->color == ads::ds::rbt::node_impl::red) {
+                    side->first->color = ads::ds::rbt::node_impl::black;
+                    side->second++;
+                }
             }
+        }
+
+        std::pair<node_ptr_t, size_t> a, b;
+
+        if (t->key < x) {
+            Cut(right.first, right.second, x, a, b);
+            lo = Join(left.first, left.second, t, a.first, a.second);
+            hi = b;
+        }
+        else {
+            Cut(left.first, left.second, x, a, b);
+            lo = a;
+            hi = Join(b.first, b.second, t, right.first, right.second);
+        }
+    }
+
+    // Appends every key of greater (all of them bigger than the keys here) in O(log n), greater ends up empty
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline void RBTree<T, Aug, Stats, Balance>::join(reference_t greater) requires red_black {
+        if (this == &greater || greater.root_ == nullptr) return;
+        if (root_ == nullptr) {
+            std::swap(root_, greater.root_);
+            std::swap(size_, greater.size_);
+
+            return;
+        }
+        if (!(maxIt()->key < greater.minIt()->key)) throw ads::ds::rbt::exception::TreeJoinException();
+
+        auto moved = greater.size_;
+        auto* k = greater.node_extract(greater.minIt());
+        auto lh = Black_height(root_);
+        auto rh = Black_height(greater.root_);
+
+        root_ = Join(root_, lh, k, greater.root_, rh).first;
+        size_ += moved;
+        greater.root_ = nullptr;
+        greater.size_ = 0;
+    }
+
+    // Moves every key >= x into greater (its previous content is dropped). The cut is O(log n), so is the
+    // size of greater with order statistics (SubtreeSize); without them it is counted, O(size of greater).
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline void RBTree<T, Aug, Stats, Balance>::split(const key_ref_t x, reference_t greater) requires red_black {
+        if (this == &greater) return;
+
+        greater.clear();
+
+        std::pair<node_ptr_t, size_t> lo, hi;
+        Cut(root_, Black_height(root_), x, lo, hi);
+
+        root_ = lo.first;
+        greater.root_ = hi.first;
+        if constexpr (order_statistics) greater.size_ = Aug::size_of(Aggregate_of(greater.root_));
+        else greater.size_ = Size(greater.root_);
+        size_ -= greater.size_;
+    }
+
+    // Range erase without red-black colors to cut along: one unlink per node from first up to last (excluded)
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline size_t RBTree<T, Aug, Stats, Balance>::Unlink_range(node_ptr_t first, node_ptr_t last) {
+        size_t n = 0;
+
+        while (first != last) {
+            auto* next = ads::ds::rbt::node_impl::successor_of<Stats>(first);
+            delete node_extract(first);
+            Stats::count(ads::ds::rbt::stats::deallocation);
+            first = next;
+            n++;
+        }
+
+        return n;
+    }
+
+    // Joins two black rooted trees, every key of lo below every key of hi, the minimum of hi becomes the middle key
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline std::pair<typename RBTree<T, Aug, Stats, Balance>::node_ptr_t, size_t> RBTree<T, Aug, Stats, Balance>::Concat(std::pair<node_ptr_t, size_t> lo, std::pair<node_ptr_t, size_t> hi) {
+        if (lo.first == nullptr) return hi;
+        if (hi.first == nullptr) return lo;
+
+        auto size = size_;
+        root_ = hi.first;
+        auto* k = node_extract(root_->min_node());
+        size_ = size;
+
+        return Join(lo.first, lo.second, k, root_, Black_height(root_));
+    }
+
+    // Frees a detached subtree and returns its number of nodes, background hands it to the shared reclaimer
+    // thread. Its size is then known from the aggregates with order statistics, otherwise it is counted side
+    // by side with the nodes kept (root_), O(smaller part) on the calling thread
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline size_t RBTree<T, Aug, Stats, Balance>::Drop(node_ptr_t p, bool background) {
+        if (p == nullptr) return 0;
+        if (!background) return Free(p);
+
+        size_t n;
 
-            if (q != nullptr) q->father = y->father;
+        if constexpr (order_statistics) n = Aug::size_of(Aggregate_of(p));
+        else n = Count_apart(p);
 
-            if (y->father == nullptr) root_ = q;
+        ads::ds::rbt::reclamation::Reclaimer::shared().post([p] { Free(p); });
+
+        return n;
+    }
+
+    // Steps through the detached subtree p and the tree in lockstep, size_ still counts both
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline size_t RBTree<T, Aug, Stats, Balance>::Count_apart(node_ptr_t p) const {
+        auto* dropped = p->min_node();
+        auto* kept = (root_ == nullptr ? nullptr : root_->min_node());
+        size_t n = 0;
+
+        while (dropped != nullptr && kept != nullptr) {
+            dropped = dropped->node_Successor();
+            kept = kept->node_Successor();
+            n++;
+        }
+
+        return (dropped == nullptr ? n : size_ - n);
+    }
+
+    // One pass without a stack: left sons are rotated up until the node on top has none, then it is freed
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline size_t RBTree<T, Aug, Stats, Balance>::Free(node_ptr_t p) {
+        size_t n = 0;
+
+        while (p != nullptr) {
+            if (p->left != nullptr) {
+                auto* l = p->left;
+                p->left = l->right;
+                l->right = p;
+                p = l;
+            }
             else {
-                if (y == y->father->left) y->father->left = q;
-                else y->father->right = q;
+                auto* next = p->right;
+                delete p;
+                p = next;
+                n++;
             }
+        }
 
-            if (y != p) {
-                p->color = y->color;
-                p->key = y->key;
-            }
+        Stats::count(ads::ds::rbt::stats::deallocation, n);
 
-            if (y->color == ads::ds::rbt::node_impl::black) Delete_fix(q);
+        return n;
+    }
 
-            size_--;
+    // Applies ops sorted by key and returns how many of them changed the tree. Equal keys apply in their order,
+    // as one insert/remove each would. With threads > 1 the tree is split at batch keys into disjoint ranges,
+    // each range takes its share of the batch on a thread of its own and the pieces are joined back.
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline size_t RBTree<T, Aug, Stats, Balance>::apply_batch(const std::vector<batch_op_t>& ops, size_t threads) {
+        for (size_t i = 1; i < ops.size(); ++i) {
+            if (ops[i].key < ops[i - 1].key) throw ads::ds::rbt::exception::TreeBatchOrderException();
+        }
 
-            return true;
+        const auto* first = ops.data();
+        const auto* last = ops.data() + ops.size();
+        auto parts = (red_black ? std::min<size_t>(std::max<size_t>(threads, 1), ops.size() / batch_grain + 1) : 1);
+
+        if (parts == 1) return Apply_sorted(first, last);
+
+        // Range i takes the batch from cuts[i] on, equal keys never straddle a cut
+        std::vector<size_t> cuts{ 0 };
+
+        for (size_t i = 1; i < parts; ++i) {
+            auto at = std::max(ops.size() * i / parts, cuts.back() + 1);
+
+            while (at < ops.size() && !(ops[at - 1].key < ops[at].key)) at++;
+
+            if (at >= ops.size()) break;
+
+            cuts.push_back(at);
+        }
+
+        cuts.push_back(ops.size());
+
+        std::vector<self_type> pieces(cuts.size() - 2);
+        std::vector<size_t> changed(cuts.size() - 1, 0);
+        std::vector<std::thread> workers;
+
+        for (auto i = pieces.size(); i > 0; --i) split(ops[cuts[i]].key, pieces[i - 1]);
+        for (size_t i = 0; i < pieces.size(); ++i) {
+            workers.emplace_back([&, i] { changed[i + 1] = pieces[i].Apply_sorted(first + cuts[i + 1], first + cuts[i + 2]); });
         }
+
+        changed[0] = Apply_sorted(first + cuts[0], first + cuts[1]);
+
+        for (auto& w : workers) w.join();
+        for (auto& piece : pieces) join(piece);
+
+        return std::accumulate(changed.begin(), changed.end(), size_t{ 0 });
     }
 
-    template <typename T>
-    inline void RBTree<T>::Delete_fix(node_ptr_t p) {
-        if (p != nullptr) {
-            node_ptr_t s;
+    // A batch that is large next to the tree is merged with its keys and rebuilt in O(n + m), a small one is
+    // walked with a finger in O(m log(n / m))
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline size_t RBTree<T, Aug, Stats, Balance>::Apply_sorted(const batch_op_t* first, const batch_op_t* last) {
+        auto m = static_cast<size_t>(last - first);
 
-            while (p != root_ && p->color == ads::ds::rbt::node_impl::black) {
-                if (p->father->left == p) {
-                    s = p->father->right;
+        if (m == 0) return 0;
+        if (m * std::bit_width(size_) >= size_) return Apply_merge(first, last);
 
-                    if (s->color == ads::ds::rbt::node_impl::red) {
-                        s->color = ads::ds::rbt::node_impl::black;
-                        p->father->color = ads::ds::rbt::node_impl::red;
-                        Rotate_left(p->father);
-                        s = p->father->right;
-                    }
-                    if (s->right->color == ads::ds::rbt::node_impl::black && s->left->color == ads::ds::rbt::node_impl::black) {
-                        s->color = ads::ds::rbt::node_impl::red;
-                        p = p->father;
-                    }
-                    else {
-                        if (s->right->color == ads::ds::rbt::node_impl::black) {
-                            s->left->color = ads::ds::rbt::node_impl::black;
-                            s->color = ads::ds::rbt::node_impl::red;
-                            Rotate_right(s);
-                            s = p->father->right;
-                        }
-
-                        s->color = p->father->color;
-                        p->father->color = ads::ds::rbt::node_impl::black;
-                        s->right->color = ads::ds::rbt::node_impl::black;
-                        Rotate_left(p->father);
-                        p = root_;
-                    }
-                }
+        return Apply_walk(first, last);
+    }
+
+    // Starts every search from the node of the previous key instead of the root, see Climb
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline size_t RBTree<T, Aug, Stats, Balance>::Apply_walk(const batch_op_t* first, const batch_op_t* last) {
+        size_t changed = 0;
+        node_ptr_t finger = nullptr;
+
+        for (auto* op = first; op != last; ++op) {
+            node_ptr_t q = nullptr;
+            auto* hit = Descend(Climb(finger, op->key), op->key, q);
+
+            if (op->op == op_t::insert) {
+                if (hit != nullptr) finger = hit;
                 else {
-                    s = p->father->left;
+                    finger = new node_t(op->key);
+                    Stats::count(ads::ds::rbt::stats::allocation);
+                    Hang(finger, q);
+                    changed++;
+                }
+            }
+            else if (hit != nullptr) {
+                // The predecessor keeps its place when hit is unlinked, so it stays a valid finger
+                finger = ads::ds::rbt::node_impl::predecessor_of<Stats>(hit);
+                delete node_extract(hit);
+                Stats::count(ads::ds::rbt::stats::deallocation);
+                changed++;
+            }
+        }
 
-                    if (s->color == ads::ds::rbt::node_impl::red) {
-                        s->color = ads::ds::rbt::node_impl::red;
-                        p->father->color = ads::ds::rbt::node_impl::red;
-                        Rotate_right(p->father);
-                        s = p->father->left;
-                    }
-                    if (s->left->color == ads::ds::rbt::node_impl::black && s->right->color == ads::ds::rbt::node_impl::black) {
-                        s->color = ads::ds::rbt::node_impl::red;
-                        p = p->father;
-                    }
-                    else {
-                        if (s->left->color == ads::ds::rbt::node_impl::black) {
-                            s->right->color = ads::ds::rbt::node_impl::black;
-                            s->color = ads::ds::rbt::node_impl::red;
-                            Rotate_left(s);
-                            s = p->father->left;
-                        }
-
-                        s->color = p->father->color;
-                        p->father->color = ads::ds::rbt::node_impl::black;
-                        s->left->color = ads::ds::rbt::node_impl::black;
-                        Rotate_right(p->father);
-                        p = root_;
-                    }
+        return changed;
+    }
+
+    // Merges the keys of the tree, moved out of their nodes in order, with the batch and builds the result bottom-up
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline size_t RBTree<T, Aug, Stats, Balance>::Apply_merge(const batch_op_t* first, const batch_op_t* last) {
+        std::vector<T> keys;
+        size_t changed = 0;
+        auto* p = minIt();
+
+        keys.reserve(size_ + static_cast<size_t>(last - first));
+
+        for (auto* op = first; op != last; ) {
+            while (p != nullptr && p->key < op->key) {
+                keys.push_back(std::move(p->key));
+                p = ads::ds::rbt::node_impl::successor_of<Stats>(p);
+            }
+
+            auto* group = op;
+            auto present = (p != nullptr && !(op->key < p->key));
+            auto was = present;
+
+            for (; op != last && !(group->key < op->key); ++op) {
+                if ((op->op == op_t::insert) != present) {
+                    present = !present;
+                    changed++;
                 }
+            }
+
+            if (was) {
+                if (present) keys.push_back(std::move(p->key));
 
-                p->color = ads::ds::rbt::node_impl::black;
-                root_->color = ads::ds::rbt::node_impl::black;
+                p = ads::ds::rbt::node_impl::successor_of<Stats>(p);
             }
+            else if (present) keys.push_back(group->key);
         }
+
+        for (; p != nullptr; p = ads::ds::rbt::node_impl::successor_of<Stats>(p)) keys.push_back(std::move(p->key));
+
+        Free(root_);
+        size_ = keys.size();
+        root_ = Build(keys.data(), keys.data() + keys.size(), 0, std::bit_width(keys.size()), 1);
+
+        return changed;
     }
 
-    template<typename T>
-    inline std::pair<typename RBTree<T>::iterator, typename RBTree<T>::iterator> RBTree<T>::bounded_range(const key_ref_t from, const key_ref_t to) {
+    // Lowest node on the way up from finger (nullptr for the root) whose subtree spans x. Only the bound on the
+    // side of x matters: for x above finger it is the first father reached from a left son, for x below it the
+    // first one reached from a right son. With x above finger, above gets that first bigger father (the lower
+    // bound when every key under the returned node is smaller than x). Takes O(log d) steps for x d keys away.
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline typename RBTree<T, Aug, Stats, Balance>::node_ptr_t RBTree<T, Aug, Stats, Balance>::Climb(node_ptr_t finger, const key_ref_t x, node_ptr_t* above) const {
+        if (above != nullptr) *above = nullptr;
+        if (finger == nullptr) return root_;
+
+        auto up = !(x < finger->key);
+        auto* p = finger;
+
+        for (;;) {
+            auto* u = p;
+
+            while (u->father != nullptr && (up ? u->father->right : u->father->left) == u) u = u->father;
+
+            auto* f = u->father;
+
+            if (f == nullptr) return p;
+
+            if (Compared(up ? x < f->key : f->key < x)) {
+                if (up && above != nullptr) *above = f;
+
+                return p;
+            }
+
+            if (!Compared(up ? f->key < x : x < f->key)) return f;
+
+            p = f;
+        }
+    }
+
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline size_t RBTree<T, Aug, Stats, Balance>::Size(node_ptr_t in) {
+        if (in == nullptr) return 0;
+        else {
+            auto ls = Size(in->left);
+            auto rs = Size(in->right);
+
+            return (ls + rs + 1);
+        }
+    }
+
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline void RBTree<T, Aug, Stats, Balance>::Display(node_ptr_t in, size_t level) {
+        if (in == nullptr) return;
+
+        std::cout << "level: " << level << std::endl;
+        std::cout << in;
+
+        Display(in->left, level + 1);
+        Display(in->right, level + 1);
+    }
+
+    template <typename T, typename Aug, typename Stats, typename Balance>
+    inline bool RBTree<T, Aug, Stats, Balance>::remove(const key_ref_t x) {
+        if (root_ == nullptr) {
+            std::cout << "\nEmpty RBTree.";
+
+            return false;
+        }
+
+        auto* p = node_find(x);
+
+        if (p == nullptr) return false;
+        else {
+            delete node_extract(p);
+            Stats::count(ads::ds::rbt::stats::deallocation);
+
+            return true;
+        }
+    }
+
+    template <typename T, typename Aug, typename Stats, typename Balance>
+    inline void RBTree<T, Aug, Stats, Balance>::Transplant(node_ptr_t u, node_ptr_t v) {
+        if (u->father == nullptr) root_ = v;
+        else if (u == u->father->left) u->father->left = v;
+        else u->father->right = v;
+
+        if (v != nullptr) v->father = u->father;
+    }
+
+    // Unlinks the node by relinking its successor in its place, keys never move between nodes
+    // so iterators and raw node pointers to other elements stay valid. Caller owns returned node.
+    template <typename T, typename Aug, typename Stats, typename Balance>
+    inline typename RBTree<T, Aug, Stats, Balance>::node_ptr_t RBTree<T, Aug, Stats, Balance>::node_extract(node_ptr_t p) {
+        auto* y = p;
+        auto y_color = y->color;
+        node_ptr_t q = nullptr;
+        node_ptr_t q_father = nullptr;
+
+        if (p->left == nullptr) {
+            q = p->right;
+            q_father = p->father;
+            Transplant(p, p->right);
+        }
+        else if (p->right == nullptr) {
+            q = p->left;
+            q_father = p->father;
+            Transplant(p, p->left);
+        }
+        else {
+            y = p->right->min_node();
+            y_color = y->color;
+            q = y->right;
+
+            if (y->father == p) q_father = y;
+            else {
+                q_father = y->father;
+                Transplant(y, y->right);
+                y->right = p->right;
+                y->right->father = y;
+            }
+
+            Transplant(p, y);
+            y->left = p->left;
+            y->left->father = y;
+            y->color = p->color;
+        }
+
+        Pull_up(q_father);
+
+        Balance::erase_fix(*this, q, q_father, y_color);
+
+        size_--;
+        p->father = nullptr;
+        p->left = nullptr;
+        p->right = nullptr;
+
+        return p;
+    }
+
+    // p is the son that took the place of the unlinked node, f its father (p may be missing)
+    template <typename T, typename Aug, typename Stats, typename Balance>
+    inline void RBTree<T, Aug, Stats, Balance>::Delete_fix(node_ptr_t p, node_ptr_t f) {
+        Links links{ *this };
+
+        ads::ds::rbt::fixup::delete_fix(links, p, f);
+    }
+
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline std::pair<typename RBTree<T, Aug, Stats, Balance>::iterator, typename RBTree<T, Aug, Stats, Balance>::iterator> RBTree<T, Aug, Stats, Balance>::bounded_range(const key_ref_t from, const key_ref_t to) {
         if (from <= to) {
             iterator f_;
             iterator t_;
@@ -652,8 +1655,8 @@ namespace ads::ds::rbt {
         }
     }
 
-    template<typename T>
-    inline std::pair<typename RBTree<T>::const_iterator, typename RBTree<T>::const_iterator> RBTree<T>::bounded_range(const key_ref_t from, const key_ref_t to) const {
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline std::pair<typename RBTree<T, Aug, Stats, Balance>::const_iterator, typename RBTree<T, Aug, Stats, Balance>::const_iterator> RBTree<T, Aug, Stats, Balance>::bounded_range(const key_ref_t from, const key_ref_t to) const {
         if (from <= to) {
             const_iterator f_;
             const_iterator t_;
@@ -677,71 +1680,131 @@ namespace ads::ds::rbt {
         }
     }
 
-    template<typename T>
-    inline std::pair<typename RBTree<T>::iterator, typename RBTree<T>::iterator> RBTree<T>::equal_range(const key_ref_t x) {
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline std::pair<typename RBTree<T, Aug, Stats, Balance>::iterator, typename RBTree<T, Aug, Stats, Balance>::iterator> RBTree<T, Aug, Stats, Balance>::equal_range(const key_ref_t x) {
         return { lower_bound(x), upper_bound(x) };
     }
 
-    template<typename T>
-    inline std::pair<typename RBTree<T>::const_iterator, typename RBTree<T>::const_iterator> RBTree<T>::equal_range(const key_ref_t x) const {
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline std::pair<typename RBTree<T, Aug, Stats, Balance>::const_iterator, typename RBTree<T, Aug, Stats, Balance>::const_iterator> RBTree<T, Aug, Stats, Balance>::equal_range(const key_ref_t x) const {
         return { lower_bound(x), upper_bound(x) };
     }
 
-    template<typename T>
-    inline typename RBTree<T>::iterator RBTree<T>::lower_bound(const key_ref_t x) {
-        for (auto it = begin(); it != end(); ++it) {
-            if (*it >= x) {
-                return it;
-            }
-        }
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline typename RBTree<T, Aug, Stats, Balance>::iterator RBTree<T, Aug, Stats, Balance>::lower_bound(const key_ref_t x) {
+        return iterator(Lower_bound(x), &root_);
+    }
 
-        return end();
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline typename RBTree<T, Aug, Stats, Balance>::const_iterator RBTree<T, Aug, Stats, Balance>::lower_bound(const key_ref_t x) const {
+        return const_iterator(Lower_bound(x), &root_);
     }
 
-    template<typename T>
-    inline typename RBTree<T>::const_iterator RBTree<T>::lower_bound(const key_ref_t x) const {
-        for (const auto it = cbegin(); it != cend(); ++it) {
-            if (*it >= x) {
-                return it;
-            }
-        }
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline typename RBTree<T, Aug, Stats, Balance>::iterator RBTree<T, Aug, Stats, Balance>::upper_bound(const key_ref_t x) {
+        return iterator(Upper_bound(x), &root_);
+    }
 
-        return cend();
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline typename RBTree<T, Aug, Stats, Balance>::const_iterator RBTree<T, Aug, Stats, Balance>::upper_bound(const key_ref_t x) const {
+        return const_iterator(Upper_bound(x), &root_);
     }
 
-    template<typename T>
-    inline typename RBTree<T>::iterator RBTree<T>::upper_bound(const key_ref_t x) {
-        for (auto it = begin(); it != end(); ++it) {
-            if (*it > x) {
-                return it;
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline typename RBTree<T, Aug, Stats, Balance>::iterator RBTree<T, Aug, Stats, Balance>::find_from(iterator finger, const key_ref_t x) {
+        node_ptr_t q = nullptr;
+
+        return iterator(Descend(Climb(finger.getIter(), x), x, q), &root_);
+    }
+
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline typename RBTree<T, Aug, Stats, Balance>::const_iterator RBTree<T, Aug, Stats, Balance>::find_from(const_iterator finger, const key_ref_t x) const {
+        node_ptr_t q = nullptr;
+
+        return const_iterator(Descend(Climb(finger.getIter(), x), x, q), &root_);
+    }
+
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline typename RBTree<T, Aug, Stats, Balance>::iterator RBTree<T, Aug, Stats, Balance>::lower_bound_from(iterator finger, const key_ref_t x) {
+        node_ptr_t above = nullptr;
+        auto* p = Climb(finger.getIter(), x, &above);
+
+        return iterator(Lower_bound(p, above, x), &root_);
+    }
+
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline typename RBTree<T, Aug, Stats, Balance>::const_iterator RBTree<T, Aug, Stats, Balance>::lower_bound_from(const_iterator finger, const key_ref_t x) const {
+        node_ptr_t above = nullptr;
+        auto* p = Climb(finger.getIter(), x, &above);
+
+        return const_iterator(Lower_bound(p, above, x), &root_);
+    }
+
+    // Keys in [from, to], empty when to is below from
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline typename RBTree<T, Aug, Stats, Balance>::view_t RBTree<T, Aug, Stats, Balance>::range(const key_ref_t from, const key_ref_t to) const {
+        if (to < from) return View(nullptr, nullptr);
+
+        return View(Lower_bound(from), Upper_bound(to));
+    }
+
+    // Nodes first up to last (nullptr for the end), the size comes from the ranks of both ends
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline typename RBTree<T, Aug, Stats, Balance>::view_t RBTree<T, Aug, Stats, Balance>::View(node_ptr_t first, node_ptr_t last) const {
+        if constexpr (order_statistics) {
+            auto lo = (first == nullptr ? size_ : rank(first->key));
+            auto hi = (last == nullptr ? size_ : rank(last->key));
+
+            return view_t(const_iterator(first, &root_), const_iterator(last, &root_), hi - lo);
+        }
+        else return view_t(const_iterator(first, &root_), const_iterator(last, &root_));
+    }
+
+    // First key not below x under t, bound when there is none
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline typename RBTree<T, Aug, Stats, Balance>::node_ptr_t RBTree<T, Aug, Stats, Balance>::Lower_bound(node_ptr_t t, node_ptr_t bound, const key_ref_t x) const {
+        Stats::count(ads::ds::rbt::stats::descent);
+
+        while (t != nullptr) {
+            if (Compared(t->key < x)) t = t->right;
+            else {
+                bound = t;
+                t = t->left;
             }
         }
 
-        return end();
+        return bound;
     }
 
-    template<typename T>
-    inline typename RBTree<T>::const_iterator RBTree<T>::upper_bound(const key_ref_t x) const {
-        for (const auto it = cbegin(); it != cend(); ++it) {
-            if (*it > x) {
-                return it;
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline typename RBTree<T, Aug, Stats, Balance>::node_ptr_t RBTree<T, Aug, Stats, Balance>::Upper_bound(const key_ref_t x) const {
+        node_ptr_t bound = nullptr;
+        auto* t = root_;
+
+        Stats::count(ads::ds::rbt::stats::descent);
+
+        while (t != nullptr) {
+            if (Compared(x < t->key)) {
+                bound = t;
+                t = t->left;
             }
+            else t = t->right;
         }
 
-        return cend();
+        return bound;
     }
 
-    template<typename T>
-    inline typename RBTree<T>::iterator RBTree<T>::erase(const_iterator pos) {
-        auto ret = iterator(pos.getIter());
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline typename RBTree<T, Aug, Stats, Balance>::iterator RBTree<T, Aug, Stats, Balance>::erase(const_iterator pos) {
+        auto ret = iterator(pos.getIter(), &root_);
         ++ret;
         remove(*pos);
 
         return ret;
     }
 
-    template<typename T>
-    inline typename RBTree<T>::iterator RBTree<T>::erase(iterator pos) {
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline typename RBTree<T, Aug, Stats, Balance>::iterator RBTree<T, Aug, Stats, Balance>::erase(iterator pos) {
         auto ret = pos;
         ++ret;
         remove(*pos);
@@ -749,28 +1812,67 @@ namespace ads::ds::rbt {
         return ret;
     }
 
-    template<typename T>
-    inline typename RBTree<T>::iterator RBTree<T>::erase(iterator first, iterator last) {
-        auto ret = last;
+    // Cuts [first, last) out with two splits and one join, then frees the detached nodes in one pass, O(log n + k).
+    // Nodes outside the range are relinked, not moved, so last stays valid.
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline typename RBTree<T, Aug, Stats, Balance>::iterator RBTree<T, Aug, Stats, Balance>::erase(iterator first, iterator last) {
+        if (first == last || first == end()) return last;
+        if constexpr (!red_black) {
+            Unlink_range(first.getIter(), last.getIter());
 
-        if (ret != end()) {
-            ++ret;
+            return last;
         }
+        else {
+            std::pair<node_ptr_t, size_t> lo, rest, mid, hi{ nullptr, 0 };
+            Cut(root_, Black_height(root_), *first, lo, rest);
 
-        std::vector<T> remover;
-        for (auto it = first; it != last; ++it) {
-            remover.push_back(*it);
+            if (last != end()) Cut(rest.first, rest.second, *last, mid, hi);
+            else mid = rest;
+
+            root_ = Concat(lo, hi).first;
+            size_ -= Drop(mid.first, false);
+
+            return last;
         }
+    }
+
+    // Drops every key < x, background leaves the freeing of the detached nodes to the reclaimer thread
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline std::size_t RBTree<T, Aug, Stats, Balance>::erase_below(const key_ref_t x, bool background) {
+        if constexpr (!red_black) return Unlink_range(minIt(), Lower_bound(x));
+        else {
+            std::pair<node_ptr_t, size_t> lo, hi;
+            Cut(root_, Black_height(root_), x, lo, hi);
+
+            root_ = hi.first;
+            auto dropped = Drop(lo.first, background);
+            size_ -= dropped;
 
-        for (auto& e : remover) {
-            remove(e);
+            return dropped;
         }
+    }
 
-        return ret;
+    // Drops every key > x, the cut is made at the first key above x
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline std::size_t RBTree<T, Aug, Stats, Balance>::erase_above(const key_ref_t x, bool background) {
+        auto* bound = Upper_bound(x);
+
+        if (bound == nullptr) return 0;
+        if constexpr (!red_black) return Unlink_range(bound, nullptr);
+        else {
+            std::pair<node_ptr_t, size_t> lo, hi;
+            Cut(root_, Black_height(root_), bound->key, lo, hi);
+
+            root_ = lo.first;
+            auto dropped = Drop(hi.first, background);
+            size_ -= dropped;
+
+            return dropped;
+        }
     }
 
-    template<typename T>
-    inline std::size_t RBTree<T>::erase(const key_ref_t key) {
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline std::size_t RBTree<T, Aug, Stats, Balance>::erase(const key_ref_t key) {
         std::size_t count = 0;
 
         while (find(key)) {
@@ -781,8 +1883,8 @@ namespace ads::ds::rbt {
         return count;
     }
 
-    template<typename T>
-    inline void RBTree<T>::swap(reference_t other) noexcept {
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline void RBTree<T, Aug, Stats, Balance>::swap(reference_t other) noexcept {
         std::vector<T> swaper;
 
         for (auto it = other.begin(); it != other.end(); ++it) {
@@ -798,15 +1900,15 @@ namespace ads::ds::rbt {
         }
     }
 
-    template<typename T>
-    inline void RBTree<T>::insert(iterator first, iterator last) {
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline void RBTree<T, Aug, Stats, Balance>::insert(iterator first, iterator last) {
         for (auto it = first; it != last; ++it) {
             insert(*it);
         }
     }
 
-    template<typename T>
-    inline std::size_t RBTree<T>::count(const key_ref_t key) {
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline std::size_t RBTree<T, Aug, Stats, Balance>::count(const key_ref_t key) {
         std::size_t count = 0;
 
         for (auto it = begin(); it != end(); ++it) {
@@ -818,8 +1920,8 @@ namespace ads::ds::rbt {
         return count;
     }
 
-    template<typename T>
-    inline void RBTree<T>::copy_from(const reference_t src) {
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline void RBTree<T, Aug, Stats, Balance>::copy_from(const reference_t src) {
         clear();
 
         for (auto& e : src) {
@@ -827,8 +1929,8 @@ namespace ads::ds::rbt {
         }
     }
 
-    template<typename T>
-    inline void RBTree<T>::copy_from(rvalue_t src) {
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline void RBTree<T, Aug, Stats, Balance>::copy_from(rvalue_t src) {
         clear();
 
         for (auto& e : src) {
@@ -836,8 +1938,8 @@ namespace ads::ds::rbt {
         }
     }
 
-    template<typename T>
-    inline std::pair<typename RBTree<T>::iterator, bool> RBTree<T>::insert_unique(const key_ref_t val) {
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline std::pair<typename RBTree<T, Aug, Stats, Balance>::iterator, bool> RBTree<T, Aug, Stats, Balance>::insert_unique(const key_ref_t val) {
         auto check = size();
         insert(val);
 
@@ -855,8 +1957,8 @@ namespace ads::ds::rbt {
         }
     }
 
-    template<typename T>
-    inline void RBTree<T>::replace(const key_ref_t replace_this, const key_ref_t with_this) {
+    template<typename T, typename Aug, typename Stats, typename Balance>
+    inline void RBTree<T, Aug, Stats, Balance>::replace(const key_ref_t replace_this, const key_ref_t with_this) {
         auto* check = node_find(replace_this);
 
         if (check) {
@@ -904,6 +2006,7 @@ namespace ads::ds::rbt {
             }
 
             check->key = with_this;
+            Pull_up(check);
         }
     }
 
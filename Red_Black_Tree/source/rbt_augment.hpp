@@ -0,0 +1,127 @@
+#ifndef RBTREE_RBT_AUGMENT_HPP
+#define RBTREE_RBT_AUGMENT_HPP
+
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+namespace ads::ds::rbt::augment {
+
+    /**
+        * Subtree augmentations
+        * An augmentation is a monoid over the keys of a subtree, every node stores the value for its own
+        * subtree and the tree keeps it current on rotations and along insert/erase paths.
+        * Required members:
+        *   value_type                               - stored in every node
+        *   static value_type identity()             - value of an empty subtree
+        *   static value_type lift(const key&)       - value of a single key
+        *   static value_type combine(lhs, rhs)      - associative, lhs holds the smaller keys
+        * Optional:
+        *   static std::size_t size_of(value_type)   - number of keys, enables order statistics
+        *   static std::uint64_t digest_of(value_type) - hash of the key sequence, enables digest/diff
+    */
+
+    // Default, nodes carry nothing and the tree skips every update
+    struct NoAugmentation {
+        struct value_type {};
+
+        template <typename K>
+        static value_type lift(const K&)                   { return {}; };
+        static value_type identity()                       { return {}; };
+        static value_type combine(value_type, value_type)  { return {}; };
+    };
+
+    // Number of keys in the subtree, gives select/rank in O(log n)
+    struct SubtreeSize {
+        typedef std::size_t value_type;
+
+        template <typename K>
+        static value_type  lift(const K&)                     { return 1; };
+        static value_type  identity()                         { return 0; };
+        static value_type  combine(value_type a, value_type b) { return a + b; };
+        static std::size_t size_of(value_type v)              { return v; };
+    };
+
+    // Sum of keys, R has to be constructible from the key
+    template <typename R>
+    struct Sum {
+        typedef R value_type;
+
+        template <typename K>
+        static value_type lift(const K& k)                                 { return value_type(k); };
+        static value_type identity()                                       { return value_type{}; };
+        static value_type combine(const value_type& a, const value_type& b) { return a + b; };
+    };
+
+    // Polynomial hash of the keys in order, h(k1..kn) = sum mix(hash(ki)) * base^(n - i) modulo 2^61 - 1.
+    // Depends only on the key sequence, never on the shape, so equal sets hash equal in any two trees.
+    struct MerkleHash {
+        struct value_type {
+            std::uint64_t hash;
+            std::uint64_t power;
+
+            bool operator==(const value_type&) const = default;
+        };
+
+        static constexpr std::uint64_t modulus = (std::uint64_t{ 1 } << 61) - 1;
+        static constexpr std::uint64_t base    = 0x1d8e4e27c47d124fULL % modulus;
+
+        template <typename K>
+        static value_type lift(const K& k)                                 { return { Mix(static_cast<std::uint64_t>(std::hash<K>{}(k))), base }; };
+        static value_type identity()                                       { return { 0, 1 }; };
+        static value_type combine(const value_type& a, const value_type& b) { return { Add(Mul(a.hash, b.power), b.hash), Mul(a.power, b.power) }; };
+        static std::uint64_t digest_of(const value_type& v)                { return v.hash; };
+
+    private:
+        static std::uint64_t Mul(std::uint64_t a, std::uint64_t b) {
+            auto p = static_cast<unsigned __int128>(a) * b;
+            auto r = (static_cast<std::uint64_t>(p) & modulus) + static_cast<std::uint64_t>(p >> 61);
+
+            return (r >= modulus ? r - modulus : r);
+        };
+
+        static std::uint64_t Add(std::uint64_t a, std::uint64_t b) { return (a + b >= modulus ? a + b - modulus : a + b); };
+
+        // splitmix64 finalizer, std::hash of integers is the identity. Never 0, or a lone key would hash
+        // like an empty range.
+        static std::uint64_t Mix(std::uint64_t x) {
+            x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+
+            return (x ^ (x >> 31)) % (modulus - 1) + 1;
+        };
+    };
+
+    // Two augmentations kept side by side, order statistics and digests come along when either one provides them
+    template <typename A, typename B>
+    struct Compose {
+        typedef std::pair<typename A::value_type, typename B::value_type> value_type;
+
+        template <typename K>
+        static value_type lift(const K& k)                                 { return { A::lift(k), B::lift(k) }; };
+        static value_type identity()                                       { return { A::identity(), B::identity() }; };
+        static value_type combine(const value_type& a, const value_type& b) { return { A::combine(a.first, b.first), B::combine(a.second, b.second) }; };
+
+        static std::size_t size_of(const value_type& v) requires requires { A::size_of(v.first); } { return A::size_of(v.first); };
+        static std::size_t size_of(const value_type& v) requires (!requires { A::size_of(v.first); } && requires { B::size_of(v.second); }) { return B::size_of(v.second); };
+        static std::uint64_t digest_of(const value_type& v) requires requires { A::digest_of(v.first); } { return A::digest_of(v.first); };
+        static std::uint64_t digest_of(const value_type& v) requires (!requires { A::digest_of(v.first); } && requires { B::digest_of(v.second); }) { return B::digest_of(v.second); };
+    };
+
+    template <typename Aug>
+    concept counts_keys = requires(const typename Aug::value_type& v) { { Aug::size_of(v) } -> std::convertible_to<std::size_t>; };
+
+    template <typename Aug>
+    concept hashes_keys = requires(const typename Aug::value_type& v) { { Aug::digest_of(v) } -> std::convertible_to<std::uint64_t>; };
+
+    template <typename Aug>
+    inline constexpr bool is_augmented = !std::is_same_v<Aug, NoAugmentation>;
+
+}
+
+#endif
@@ -0,0 +1,238 @@
+#ifndef RBTREE_RBT_BALANCE_HPP
+#define RBTREE_RBT_BALANCE_HPP
+
+#pragma once
+
+#include "rbt_node.hpp"
+#include <cmath>
+#include <cstddef>
+
+namespace ads::ds::rbt::balance {
+
+    /**
+        * Balancing policies
+        * The tree hands every fresh leaf and every unlinked node to its Balance policy, which restores the
+        * balance with the rotations and the color field of the tree. RedBlack keeps the colors, the rank
+        * based policies reuse the field as a rank (leaves 0, a missing son counts as -1).
+        * Required members:
+        *   red_black                                  - true when the color field holds red/black
+        *   leaf                                       - color of a fresh leaf
+        *   static bool insert_fix(tree, leaf)         - after hanging a leaf, true when the tree grew
+        *   static void erase_fix(tree, son, father, color) - after unlinking a node of the given color, son
+        *                                                took the place of the node spliced out under father
+        *   static double height_bound(n)              - worst case height of a tree of n keys
+        *   static bool valid(node)                    - rank rule of one node (rank based policies only)
+        * Split, join and the range erase need red-black colors, the other policies fall back to one
+        * unlink per key for the range erase.
+    */
+
+    // Default, the classic Insert_fix/Delete_fix of the tree
+    struct RedBlack {
+        static constexpr bool red_black = true;
+        static constexpr int  leaf      = ads::ds::rbt::node_impl::red;
+
+        static double height_bound(std::size_t n) { return 2.0 * std::log2(static_cast<double>(n) + 1.0); };
+
+        template <typename Tree>
+        static bool insert_fix(Tree& t, typename Tree::node_ptr_t x) { return t.Insert_fix(x); };
+
+        template <typename Tree>
+        static void erase_fix(Tree& t, typename Tree::node_ptr_t q, typename Tree::node_ptr_t f, int color) {
+            if (color == ads::ds::rbt::node_impl::black) t.Delete_fix(q, f);
+        };
+    };
+
+    // Insertion shared by AVL and WAVL, the two only differ when deleting
+    struct Ranked {
+        static constexpr bool red_black = false;
+        static constexpr int  leaf      = 0;
+
+        template <typename Node>
+        static int rank_of(const Node* n) { return (n == nullptr ? -1 : n->color); };
+
+        // Promotes along 0-children, one single or double rotation ends the walk
+        template <typename Tree>
+        static bool insert_fix(Tree& t, typename Tree::node_ptr_t x) {
+            auto* p = x->father;
+
+            while (p != nullptr && rank_of(p) == rank_of(x)) {
+                auto* s = (p->left == x ? p->right : p->left);
+
+                if (rank_of(p) - rank_of(s) == 1) {
+                    Tree::Paint(p, p->color + 1);
+                    x = p;
+                    p = p->father;
+
+                    continue;
+                }
+
+                auto* z = (p->left == x ? x->right : x->left);
+
+                if (z == nullptr || rank_of(x) - rank_of(z) == 2) {
+                    if (p->left == x) t.Rotate_right(p);
+                    else t.Rotate_left(p);
+
+                    Tree::Paint(p, p->color - 1);
+                }
+                else {
+                    if (p->left == x) {
+                        t.Rotate_left(x);
+                        t.Rotate_right(p);
+                    }
+                    else {
+                        t.Rotate_right(x);
+                        t.Rotate_left(p);
+                    }
+
+                    Tree::Paint(z, z->color + 1);
+                    Tree::Paint(x, x->color - 1);
+                    Tree::Paint(p, p->color - 1);
+                }
+
+                return false;
+            }
+
+            return p == nullptr;
+        };
+    };
+
+    // Height balanced: ranks are heights - 1 and the sons of a node differ by one at most
+    struct AVL : Ranked {
+        static double height_bound(std::size_t n) { return 1.4405 * std::log2(static_cast<double>(n) + 2.0) - 0.3277; };
+
+        template <typename Node>
+        static bool valid(const Node* n) {
+            auto l = rank_of(n->left);
+            auto r = rank_of(n->right);
+
+            return n->color == (l > r ? l : r) + 1 && l - r <= 1 && r - l <= 1;
+        };
+
+        // Retraces from the father of the spliced out node and stops at the first subtree whose height held
+        template <typename Tree>
+        static void erase_fix(Tree& t, typename Tree::node_ptr_t, typename Tree::node_ptr_t f, int) {
+            for (auto* p = f; p != nullptr; ) {
+                auto old = p->color;
+                auto l = rank_of(p->left);
+                auto r = rank_of(p->right);
+
+                if (l - r <= 1 && r - l <= 1) {
+                    Fit<Tree>(p);
+
+                    if (p->color == old) return;
+
+                    p = p->father;
+
+                    continue;
+                }
+
+                auto* c = (l > r ? p->left : p->right);
+                auto* inner = (l > r ? c->right : c->left);
+                auto* outer = (l > r ? c->left : c->right);
+
+                if (rank_of(inner) > rank_of(outer)) {
+                    if (l > r) t.Rotate_left(c);
+                    else t.Rotate_right(c);
+
+                    Fit<Tree>(c);
+                    c = inner;
+                }
+
+                if (l > r) t.Rotate_right(p);
+                else t.Rotate_left(p);
+
+                Fit<Tree>(p);
+                Fit<Tree>(c);
+
+                if (c->color == old) return;
+
+                p = c->father;
+            }
+        };
+
+    private:
+        template <typename Tree>
+        static void Fit(typename Tree::node_ptr_t n) {
+            auto l = rank_of(n->left);
+            auto r = rank_of(n->right);
+
+            Tree::Paint(n, (l > r ? l : r) + 1);
+        };
+    };
+
+    // Weak AVL: rank differences are 1 or 2 and leaves have rank 0. Built by insertions only it is an AVL
+    // tree, deletions rebalance with O(1) rotations and may leave 2,2 nodes behind.
+    struct WAVL : Ranked {
+        static double height_bound(std::size_t n) { return 2.0 * std::log2(static_cast<double>(n) + 1.0); };
+
+        template <typename Node>
+        static bool valid(const Node* n) {
+            auto l = n->color - rank_of(n->left);
+            auto r = n->color - rank_of(n->right);
+
+            if (n->left == nullptr && n->right == nullptr) return n->color == 0;
+
+            return l >= 1 && l <= 2 && r >= 1 && r <= 2;
+        };
+
+        template <typename Tree>
+        static void erase_fix(Tree& t, typename Tree::node_ptr_t x, typename Tree::node_ptr_t p, int) {
+            if (p == nullptr) return;
+
+            // A leaf of rank 1 lost its last son
+            if (p->left == nullptr && p->right == nullptr && p->color == 1) {
+                Tree::Paint(p, 0);
+                x = p;
+                p = p->father;
+            }
+
+            // Demotes while x is a 3-child and its sibling allows it
+            while (p != nullptr && p->color - rank_of(x) == 3) {
+                auto* y = (p->left == x ? p->right : p->left);
+
+                if (p->color - y->color == 2) Tree::Paint(p, p->color - 1);
+                else if (y->color - rank_of(y->left) == 2 && y->color - rank_of(y->right) == 2) {
+                    Tree::Paint(p, p->color - 1);
+                    Tree::Paint(y, y->color - 1);
+                }
+                else break;
+
+                x = p;
+                p = p->father;
+            }
+
+            if (p == nullptr || p->color - rank_of(x) != 3) return;
+
+            // The sibling is a 1-child with a 1-child, one single or double rotation finishes
+            auto left = (p->left == x);
+            auto* y = (left ? p->right : p->left);
+            auto* v = (left ? y->left : y->right);
+            auto* w = (left ? y->right : y->left);
+
+            if (y->color - rank_of(w) == 1) {
+                if (left) t.Rotate_left(p);
+                else t.Rotate_right(p);
+
+                Tree::Paint(y, y->color + 1);
+                Tree::Paint(p, p->color - (p->left == nullptr && p->right == nullptr ? 2 : 1));
+            }
+            else {
+                if (left) {
+                    t.Rotate_right(y);
+                    t.Rotate_left(p);
+                }
+                else {
+                    t.Rotate_left(y);
+                    t.Rotate_right(p);
+                }
+
+                Tree::Paint(v, v->color + 2);
+                Tree::Paint(y, y->color - 1);
+                Tree::Paint(p, p->color - 2);
+            }
+        };
+    };
+
+}
+
+#endif
@@ -0,0 +1,431 @@
+#ifndef RBTREE_RBT_BUCKET_TREE_HPP
+#define RBTREE_RBT_BUCKET_TREE_HPP
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iostream>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include "rbt_fixup.hpp"
+
+namespace ads::ds::rbt {
+
+    /**
+        * Red-Black Tree of sorted buckets
+        * Every node holds a sorted array of up to B keys, all of them between the keys of its left and its
+        * right subtree. A search compares against the first and the last key of a bucket on the way down
+        * and scans the one bucket that may hold the key, so the red-black balancing (and the 32 bytes of
+        * links and color) is paid once per bucket instead of once per key, and the bottom levels of the
+        * per-key tree collapse into one contiguous scan.
+        * A full bucket splits into two halves, the upper one linked in as its successor; a bucket that drops
+        * below B/4 keys merges with a neighbour when both fit into one, an empty one is unlinked.
+        * Iterators walk a bucket before stepping to the next node. Insert and remove invalidate them.
+    */
+    template <typename T, std::size_t B = 32>
+    class BucketRBTree {
+        static_assert(B >= 4 && B <= 0xFFFF, "Buckets hold 4 to 65535 keys");
+
+    public:
+        struct Node {
+            Node*         sons[2];     // 0 left, 1 right
+            Node*         father;
+            std::uint16_t count;
+            bool          red;
+            T             keys[B];
+        };
+
+        class const_iterator;
+
+        typedef T                   key_t;
+        typedef const T&            key_ref_t;
+        typedef Node                node_t;
+        typedef Node*               node_ptr_t;
+        typedef BucketRBTree<T, B>  self_type;
+        typedef const_iterator      iterator;
+
+        static constexpr std::size_t bucket_capacity = B;
+
+        BucketRBTree()                              : root_{ nullptr }, size_{ 0 }, buckets_{ 0 } {};
+        BucketRBTree(std::initializer_list<T> init) : BucketRBTree() { for (auto& e : init) insert(e); };
+        BucketRBTree(const self_type& s)            : root_{ Copy(s.root_, nullptr) }, size_{ s.size_ }, buckets_{ s.buckets_ } {};
+        BucketRBTree(self_type&& s) noexcept        : BucketRBTree() { swap(s); };
+        ~BucketRBTree()                                                    { Chop(root_); };
+
+        self_type& operator=(self_type s) noexcept { swap(s); return *this; };
+
+        std::size_t          size()    const noexcept { return size_; };
+        std::size_t          buckets() const noexcept { return buckets_; };
+        [[nodiscard]] bool   isEmpty() const noexcept { return size_ == 0; };
+        const Node*          getRoot() const noexcept { return root_; };
+        void                 clear() noexcept         { Chop(root_); root_ = nullptr; size_ = 0; buckets_ = 0; };
+        void                 swap(self_type& s) noexcept;
+        bool                 insert(key_ref_t);
+        bool                 remove(key_ref_t);
+        std::size_t          erase(key_ref_t x)          { return remove(x) ? 1 : 0; };
+        bool                 find(key_ref_t) const;
+        const_iterator       lower_bound(key_ref_t) const;
+        const_iterator       upper_bound(key_ref_t) const;
+        const_iterator       begin()  const              { return const_iterator(this, Outer(root_, 0), 0); };
+        const_iterator       end()    const              { return const_iterator(this, nullptr, 0); };
+        const_iterator       cbegin() const              { return begin(); };
+        const_iterator       cend()   const              { return end(); };
+
+        friend std::ostream& operator<<(std::ostream& ofs, const self_type& tree) {
+            for (auto it = tree.cbegin(); it != tree.cend(); ++it) ofs << *it << ", ";
+
+            ofs << "\n";
+
+            return ofs;
+        }
+
+    private:
+        // Link access for the shared red-black fixups (rbt_fixup.hpp), Tree is const for reading only
+        template <typename Tree>
+        struct Links {
+            typedef Node* handle_t;
+
+            static constexpr Node* nil = nullptr;
+
+            Tree& t;
+
+            Node* root()                      const { return t.root_; };
+            Node* son(Node* n, int d)         const { return n->sons[d]; };
+            Node* father(Node* n)             const { return n->father; };
+            bool  red(Node* n)                const { return n != nullptr && n->red; };
+            void  paint(Node* n, bool red)          { n->red = red; };
+            Node* rotate(Node* n, int d)            { return ads::ds::rbt::fixup::rotate(*this, n, d); };
+            void  set_root(Node* n)                 { t.root_ = n; };
+            void  set_son(Node* n, int d, Node* s)  { n->sons[d] = s; };
+            void  set_father(Node* n, Node* f)      { n->father = f; };
+        };
+
+        Node*              Outer(Node* n, int d) const { return ads::ds::rbt::fixup::outer(Links<const self_type>{ *this }, n, d); };
+        Node*              Next(Node*, int) const;
+        static std::size_t Below(const Node*, key_ref_t);
+        static std::size_t Upto(const Node*, key_ref_t);
+        static Node*       Copy(const Node*, Node*);
+        static void        Chop(Node*);
+        Node*              Split(Node*);
+        void               Unlink(Node*);
+
+        Node*       root_;
+        std::size_t size_;
+        std::size_t buckets_;
+    };
+
+    template <typename T, std::size_t B>
+    class BucketRBTree<T, B>::const_iterator {
+    public:
+        typedef std::bidirectional_iterator_tag iterator_category;
+        typedef T                               value_type;
+        typedef std::ptrdiff_t                  difference_type;
+        typedef const T*                        pointer;
+        typedef const T&                        reference;
+
+        const_iterator()                                               : tree_{ nullptr }, at_{ nullptr }, i_{ 0 } {};
+        const_iterator(const BucketRBTree* tree, Node* at, std::size_t i) : tree_{ tree }, at_{ at }, i_{ i } {};
+
+        reference       operator*()  const                        { return at_->keys[i_]; };
+        pointer         operator->() const                        { return &at_->keys[i_]; };
+        const_iterator  operator++(int)                           { auto old = *this; ++(*this); return old; };
+        const_iterator  operator--(int)                           { auto old = *this; --(*this); return old; };
+        bool            operator==(const const_iterator& s) const { return at_ == s.at_ && i_ == s.i_; };
+        bool            operator!=(const const_iterator& s) const { return !(*this == s); };
+        explicit        operator bool() const                     { return at_ != nullptr; };
+
+        // Within the bucket first, the next node only past its last key
+        const_iterator& operator++() {
+            if (++i_ < at_->count) return *this;
+
+            at_ = tree_->Next(at_, 1);
+            i_ = 0;
+
+            return *this;
+        };
+
+        const_iterator& operator--() {
+            if (at_ != nullptr && i_ > 0) {
+                --i_;
+
+                return *this;
+            }
+
+            at_ = (at_ == nullptr ? tree_->Outer(tree_->root_, 1) : tree_->Next(at_, 0));
+            i_ = (at_ == nullptr ? 0 : at_->count - 1u);
+
+            return *this;
+        };
+
+    private:
+        const BucketRBTree* tree_;
+        Node*               at_;
+        std::size_t         i_;
+    };
+
+    // Next bucket for d = 1, previous one for d = 0
+    template <typename T, std::size_t B>
+    inline typename BucketRBTree<T, B>::Node* BucketRBTree<T, B>::Next(Node* n, int d) const {
+        if (n->sons[d] != nullptr) return Outer(n->sons[d], 1 - d);
+
+        auto* f = n->father;
+
+        while (f != nullptr && f->sons[d] == n) {
+            n = f;
+            f = f->father;
+        }
+
+        return f;
+    }
+
+    // Keys of the bucket below x. Arithmetic keys are counted without branches over the whole bucket,
+    // a loop the compiler turns into vector compares; other keys stop at the first one not below x.
+    template <typename T, std::size_t B>
+    inline std::size_t BucketRBTree<T, B>::Below(const Node* n, key_ref_t x) {
+        std::size_t i = 0;
+
+        if constexpr (std::is_arithmetic_v<T>) {
+            for (std::size_t k = 0; k < n->count; ++k) i += (n->keys[k] < x);
+        }
+        else {
+            while (i < n->count && n->keys[i] < x) ++i;
+        }
+
+        return i;
+    }
+
+    // Keys of the bucket not above x
+    template <typename T, std::size_t B>
+    inline std::size_t BucketRBTree<T, B>::Upto(const Node* n, key_ref_t x) {
+        std::size_t i = 0;
+
+        if constexpr (std::is_arithmetic_v<T>) {
+            for (std::size_t k = 0; k < n->count; ++k) i += !(x < n->keys[k]);
+        }
+        else {
+            while (i < n->count && !(x < n->keys[i])) ++i;
+        }
+
+        return i;
+    }
+
+    template <typename T, std::size_t B>
+    inline bool BucketRBTree<T, B>::find(key_ref_t x) const {
+        auto* p = root_;
+
+        while (p != nullptr) {
+            if (x < p->keys[0]) p = p->sons[0];
+            else if (p->keys[p->count - 1] < x) p = p->sons[1];
+            else {
+                auto i = Below(p, x);
+
+                return !(x < p->keys[i]);
+            }
+        }
+
+        return false;
+    }
+
+    template <typename T, std::size_t B>
+    inline typename BucketRBTree<T, B>::const_iterator BucketRBTree<T, B>::lower_bound(key_ref_t x) const {
+        auto* p = root_;
+        Node* best = nullptr;
+
+        while (p != nullptr) {
+            if (p->keys[p->count - 1] < x) p = p->sons[1];
+            else if (!(p->keys[0] < x)) {
+                best = p;
+                p = p->sons[0];
+            }
+            else return const_iterator(this, p, Below(p, x));
+        }
+
+        return const_iterator(this, best, 0);
+    }
+
+    template <typename T, std::size_t B>
+    inline typename BucketRBTree<T, B>::const_iterator BucketRBTree<T, B>::upper_bound(key_ref_t x) const {
+        auto* p = root_;
+        Node* best = nullptr;
+
+        while (p != nullptr) {
+            if (!(x < p->keys[p->count - 1])) p = p->sons[1];
+            else if (x < p->keys[0]) {
+                best = p;
+                p = p->sons[0];
+            }
+            else return const_iterator(this, p, Upto(p, x));
+        }
+
+        return const_iterator(this, best, 0);
+    }
+
+    // A key past the ends of every bucket on the way down goes to the last bucket visited, it lies
+    // between that bucket and its neighbour on the side the search fell off
+    template <typename T, std::size_t B>
+    inline bool BucketRBTree<T, B>::insert(key_ref_t x) {
+        if (root_ == nullptr) {
+            root_ = new Node{};
+            root_->keys[0] = x;
+            root_->count = 1;
+            size_ = 1;
+            buckets_ = 1;
+
+            return true;
+        }
+
+        auto* p = root_;
+        Node* q = nullptr;
+
+        while (p != nullptr) {
+            q = p;
+
+            if (x < p->keys[0]) p = p->sons[0];
+            else if (p->keys[p->count - 1] < x) p = p->sons[1];
+            else break;
+        }
+
+        auto* target = (p != nullptr ? p : q);
+        auto i = Below(target, x);
+
+        if (i < target->count && !(x < target->keys[i])) return false;
+
+        if (target->count == B) {
+            auto* upper = Split(target);
+
+            if (i > target->count) {
+                i -= target->count;
+                target = upper;
+            }
+        }
+
+        for (auto k = static_cast<std::size_t>(target->count); k > i; --k) target->keys[k] = std::move(target->keys[k - 1]);
+
+        target->keys[i] = x;
+        target->count++;
+        size_++;
+
+        return true;
+    }
+
+    // Moves the upper half of a full bucket into a new node hung in as its successor
+    template <typename T, std::size_t B>
+    inline typename BucketRBTree<T, B>::Node* BucketRBTree<T, B>::Split(Node* n) {
+        auto* upper = new Node{};
+        constexpr std::size_t half = B / 2;
+
+        for (std::size_t k = half; k < B; ++k) upper->keys[k - half] = std::move(n->keys[k]);
+
+        upper->count = static_cast<std::uint16_t>(B - half);
+        upper->red = true;
+        n->count = static_cast<std::uint16_t>(half);
+
+        if (n->sons[1] == nullptr) {
+            n->sons[1] = upper;
+            upper->father = n;
+        }
+        else {
+            auto* s = Outer(n->sons[1], 0);
+            s->sons[0] = upper;
+            upper->father = s;
+        }
+
+        buckets_++;
+
+        Links<self_type> links{ *this };
+        ads::ds::rbt::fixup::insert_fix(links, upper);
+
+        return upper;
+    }
+
+    template <typename T, std::size_t B>
+    inline bool BucketRBTree<T, B>::remove(key_ref_t x) {
+        auto* p = root_;
+
+        while (p != nullptr) {
+            if (x < p->keys[0]) p = p->sons[0];
+            else if (p->keys[p->count - 1] < x) p = p->sons[1];
+            else break;
+        }
+
+        if (p == nullptr) return false;
+
+        auto i = Below(p, x);
+
+        if (x < p->keys[i]) return false;
+
+        for (auto k = i + 1; k < p->count; ++k) p->keys[k - 1] = std::move(p->keys[k]);
+
+        p->count--;
+        size_--;
+
+        if (p->count == 0) {
+            Unlink(p);
+
+            return true;
+        }
+
+        if (p->count >= B / 4) return true;
+
+        // Underflow, the successor moves into p or p moves into the predecessor when they fit together
+        if (auto* n = Next(p, 1); n != nullptr && p->count + n->count <= B) {
+            for (std::size_t k = 0; k < n->count; ++k) p->keys[p->count + k] = std::move(n->keys[k]);
+
+            p->count = static_cast<std::uint16_t>(p->count + n->count);
+            Unlink(n);
+        }
+        else if (auto* v = Next(p, 0); v != nullptr && v->count + p->count <= B) {
+            for (std::size_t k = 0; k < p->count; ++k) v->keys[v->count + k] = std::move(p->keys[k]);
+
+            v->count = static_cast<std::uint16_t>(v->count + p->count);
+            Unlink(p);
+        }
+
+        return true;
+    }
+
+    // Buckets never move between nodes, the successor node is relinked in place of p
+    template <typename T, std::size_t B>
+    inline void BucketRBTree<T, B>::Unlink(Node* p) {
+        Links<self_type> links{ *this };
+        ads::ds::rbt::fixup::erase(links, p);
+
+        delete p;
+        buckets_--;
+    }
+
+    template <typename T, std::size_t B>
+    inline typename BucketRBTree<T, B>::Node* BucketRBTree<T, B>::Copy(const Node* n, Node* father) {
+        if (n == nullptr) return nullptr;
+
+        auto* c = new Node(*n);
+        c->father = father;
+        c->sons[0] = Copy(n->sons[0], c);
+        c->sons[1] = Copy(n->sons[1], c);
+
+        return c;
+    }
+
+    template <typename T, std::size_t B>
+    inline void BucketRBTree<T, B>::Chop(Node* n) {
+        if (n == nullptr) return;
+
+        Chop(n->sons[0]);
+        Chop(n->sons[1]);
+
+        delete n;
+    }
+
+    template <typename T, std::size_t B>
+    inline void BucketRBTree<T, B>::swap(self_type& s) noexcept {
+        std::swap(root_, s.root_);
+        std::swap(size_, s.size_);
+        std::swap(buckets_, s.buckets_);
+    }
+
+}
+
+#endif
@@ -0,0 +1,452 @@
+#ifndef RBTREE_RBT_COMPACT_TREE_HPP
+#define RBTREE_RBT_COMPACT_TREE_HPP
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+namespace ads::ds::rbt {
+
+    /**
+        * Red-Black Tree without father links
+        * Nodes keep two son links, the key and one color byte, for RBTree<int> that is 24 bytes instead of 40.
+        * Insert and erase remember the way down in a stack of at most max_height nodes and rebalance from it
+        * bottom-up, iterators carry the path from the root to their node. The root hangs as the left son of
+        * a head that stands in for the father of the root, so the root needs no special case.
+        * max_height covers every tree that fits a 48-bit address space (fewer than 2^44 nodes of 24 bytes
+        * give a height of at most 88).
+    */
+    template <typename T>
+    class CompactRBTree {
+    public:
+        struct Links {
+            Links* sons[2]{ nullptr, nullptr };      // 0 left, 1 right
+        };
+
+        struct Node : Links {
+            T    key;
+            bool red;
+
+            explicit Node(const T& k) : key{ k }, red{ true } {};
+        };
+
+        class const_iterator;
+
+        typedef T                 key_t;
+        typedef const T&          key_ref_t;
+        typedef Node              node_t;
+        typedef Node*             node_ptr_t;
+        typedef CompactRBTree<T>  self_type;
+        typedef const_iterator    iterator;
+
+        static constexpr std::size_t max_height    = 96;
+        static constexpr std::size_t inline_height = 32;     // iterator path kept in place, 2^16 - 1 keys at least
+
+        CompactRBTree()                                 : size_{ 0 } {};
+        CompactRBTree(std::initializer_list<T> init)    : size_{ 0 } { for (auto& e : init) insert(e); };
+        CompactRBTree(const CompactRBTree& s)           : size_{ s.size_ } { head_.sons[0] = Copy(s.Root()); };
+        CompactRBTree(CompactRBTree&& s) noexcept       : size_{ std::exchange(s.size_, 0) } { head_.sons[0] = std::exchange(s.head_.sons[0], nullptr); };
+        CompactRBTree& operator=(CompactRBTree s) noexcept { swap(s); return *this; };
+        ~CompactRBTree()                                                             { Free(Root()); };
+
+        node_ptr_t         getRoot() const noexcept  { return Root(); };
+        std::size_t        size()    const noexcept  { return size_; };
+        [[nodiscard]] bool isEmpty() const noexcept  { return size_ == 0; };
+        void               clear() noexcept          { Free(Root()); head_.sons[0] = nullptr; size_ = 0; };
+        void               swap(CompactRBTree& s) noexcept { std::swap(head_.sons[0], s.head_.sons[0]); std::swap(size_, s.size_); };
+        bool               insert(key_ref_t);
+        bool               remove(key_ref_t);
+        std::size_t        erase(key_ref_t x)        { return remove(x) ? 1 : 0; };
+        bool               find(key_ref_t) const;
+        const_iterator     lower_bound(key_ref_t) const;
+        const_iterator     upper_bound(key_ref_t) const;
+        const_iterator     begin()  const;
+        const_iterator     end()    const            { return const_iterator(&head_); };
+        const_iterator     cbegin() const            { return begin(); };
+        const_iterator     cend()   const            { return end(); };
+
+        friend std::ostream& operator<<(std::ostream& ofs, const self_type& tree) {
+            for (auto it = tree.cbegin(); it != tree.cend(); ++it) ofs << *it << ", ";
+
+            ofs << "\n";
+
+            return ofs;
+        }
+
+    private:
+        static bool       Red(const Links* n)       { return n != nullptr && static_cast<const Node*>(n)->red; };
+        static node_ptr_t As_node(Links* n)         { return static_cast<node_ptr_t>(n); };
+        static node_ptr_t Copy(const Node*);
+        static void       Free(Links*);
+        node_ptr_t        Root() const              { return As_node(head_.sons[0]); };
+
+        Links       head_;
+        std::size_t size_;
+    };
+
+    // Keeps the nodes from the root down to the current one, an empty path is end(). The first inline_height
+    // nodes live in the iterator, a deeper path moves to a max_height block on the heap; copies take only
+    // the depth_ nodes in use
+    template <typename T>
+    class CompactRBTree<T>::const_iterator {
+    public:
+        typedef std::bidirectional_iterator_tag iterator_category;
+        typedef T                               value_type;
+        typedef std::ptrdiff_t                  difference_type;
+        typedef const T*                        pointer;
+        typedef const T&                        reference;
+
+        const_iterator()                                          : head_{ nullptr }, depth_{ 0 } {};
+        explicit const_iterator(const Links* head)                : head_{ head }, depth_{ 0 } {};
+        const_iterator(const const_iterator& s)                   : head_{ s.head_ }, depth_{ 0 } { Assign(s); };
+        const_iterator& operator=(const const_iterator& s)        { if (this != &s) { head_ = s.head_; Assign(s); } return *this; };
+        const_iterator(const_iterator&& s) noexcept               : head_{ s.head_ }, spill_{ std::move(s.spill_) }, depth_{ std::exchange(s.depth_, 0) } { Take(s); };
+        const_iterator& operator=(const_iterator&& s) noexcept    { if (this != &s) { head_ = s.head_; spill_ = std::move(s.spill_); depth_ = std::exchange(s.depth_, 0); Take(s); } return *this; };
+
+        reference       operator*()  const                        { return Path()[depth_ - 1]->key; };
+        pointer         operator->() const                        { return &Path()[depth_ - 1]->key; };
+        const_iterator& operator++()                              { Step(1); return *this; };
+        const_iterator  operator++(int)                           { auto old = *this; Step(1); return old; };
+        const_iterator& operator--()                              { Step(0); return *this; };
+        const_iterator  operator--(int)                           { auto old = *this; Step(0); return old; };
+        bool            operator==(const const_iterator& s) const { return Top() == s.Top(); };
+        bool            operator!=(const const_iterator& s) const { return Top() != s.Top(); };
+        explicit        operator bool() const                     { return depth_ != 0; };
+
+    private:
+        friend class CompactRBTree<T>;
+
+        const Node* const* Path() const { return (spill_ ? spill_.get() : in_place_); };
+        const Node**       Path()       { return (spill_ ? spill_.get() : in_place_); };
+        const Node*        Top() const  { return (depth_ == 0 ? nullptr : Path()[depth_ - 1]); };
+
+        void Push(const Node* n) {
+            if (depth_ == inline_height && !spill_) {
+                spill_ = std::make_unique<const Node*[]>(max_height);
+                std::copy(in_place_, in_place_ + depth_, spill_.get());
+            }
+
+            Path()[depth_++] = n;
+        };
+
+        void Assign(const const_iterator& s) {
+            depth_ = 0;
+
+            if (s.depth_ <= inline_height) spill_.reset();
+
+            for (std::size_t i = 0; i < s.depth_; ++i) Push(s.Path()[i]);
+        };
+
+        // After a move the path is either in the block taken over or still in place in s
+        void Take(const const_iterator& s) {
+            if (!spill_) std::copy(s.in_place_, s.in_place_ + depth_, in_place_);
+        };
+
+        // Goes to the outermost node on side 1 - dir below n, i.e. the first or last key of its subtree
+        void Dive(const Node* n, int dir) {
+            for (; n != nullptr; n = static_cast<const Node*>(n->sons[1 - dir])) Push(n);
+        };
+
+        // dir 1 steps to the next key, 0 to the previous one; stepping back from end() lands on the last key
+        void Step(int dir) {
+            if (depth_ == 0) {
+                if (dir == 0) Dive(static_cast<const Node*>(head_->sons[0]), 0);
+
+                return;
+            }
+
+            if (auto* son = Path()[depth_ - 1]->sons[dir]; son != nullptr) {
+                Dive(static_cast<const Node*>(son), dir);
+
+                return;
+            }
+
+            // Climbs while coming from the dir side, the first father reached from the other side is next
+            for (;;) {
+                auto* from = Path()[--depth_];
+
+                if (depth_ == 0 || Path()[depth_ - 1]->sons[1 - dir] == from) return;
+            }
+        };
+
+        const Links*                   head_;
+        const Node*                    in_place_[inline_height];
+        std::unique_ptr<const Node*[]> spill_;
+        std::size_t                    depth_;
+    };
+
+    template <typename T>
+    inline typename CompactRBTree<T>::node_ptr_t CompactRBTree<T>::Copy(const Node* n) {
+        if (n == nullptr) return nullptr;
+
+        auto* create = new Node(n->key);
+        create->red = n->red;
+        create->sons[0] = Copy(static_cast<const Node*>(n->sons[0]));
+        create->sons[1] = Copy(static_cast<const Node*>(n->sons[1]));
+
+        return create;
+    }
+
+    // Frees a subtree in one pass without a stack by rotating left sons up first
+    template <typename T>
+    inline void CompactRBTree<T>::Free(Links* p) {
+        while (p != nullptr) {
+            if (p->sons[0] != nullptr) {
+                auto* l = p->sons[0];
+                p->sons[0] = l->sons[1];
+                l->sons[1] = p;
+                p = l;
+            }
+            else {
+                auto* next = p->sons[1];
+                delete As_node(p);
+                p = next;
+            }
+        }
+    }
+
+    template <typename T>
+    inline bool CompactRBTree<T>::find(key_ref_t x) const {
+        for (auto* p = Root(); p != nullptr; ) {
+            if (x < p->key) p = As_node(p->sons[0]);
+            else if (p->key < x) p = As_node(p->sons[1]);
+            else return true;
+        }
+
+        return false;
+    }
+
+    template <typename T>
+    inline typename CompactRBTree<T>::const_iterator CompactRBTree<T>::begin() const {
+        const_iterator it(&head_);
+        it.Dive(Root(), 1);
+
+        return it;
+    }
+
+    // The path is kept down to the bound, then cut back to the last node where the search went left
+    template <typename T>
+    inline typename CompactRBTree<T>::const_iterator CompactRBTree<T>::lower_bound(key_ref_t x) const {
+        const_iterator it(&head_);
+        std::size_t keep = 0;
+
+        for (auto* p = Root(); p != nullptr; ) {
+            it.Push(p);
+
+            if (p->key < x) p = As_node(p->sons[1]);
+            else {
+                keep = it.depth_;
+                p = As_node(p->sons[0]);
+            }
+        }
+
+        it.depth_ = keep;
+
+        return it;
+    }
+
+    template <typename T>
+    inline typename CompactRBTree<T>::const_iterator CompactRBTree<T>::upper_bound(key_ref_t x) const {
+        const_iterator it(&head_);
+        std::size_t keep = 0;
+
+        for (auto* p = Root(); p != nullptr; ) {
+            it.Push(p);
+
+            if (x < p->key) {
+                keep = it.depth_;
+                p = As_node(p->sons[0]);
+            }
+            else p = As_node(p->sons[1]);
+        }
+
+        it.depth_ = keep;
+
+        return it;
+    }
+
+    // pa[0] is the head, pa[i] went to its son on side da[i]. The new node is red, a red father is fixed
+    // by recoloring up two levels at a time or by one single or double rotation.
+    template <typename T>
+    inline bool CompactRBTree<T>::insert(key_ref_t x) {
+        std::array<Links*, max_height + 1> pa;
+        std::array<int, max_height + 1> da;
+        std::size_t k = 1;
+
+        pa[0] = &head_;
+        da[0] = 0;
+
+        for (auto* p = Root(); p != nullptr; p = As_node(p->sons[da[k - 1]])) {
+            if (!(x < p->key) && !(p->key < x)) return false;
+
+            pa[k] = p;
+            da[k++] = (p->key < x ? 1 : 0);
+        }
+
+        pa[k - 1]->sons[da[k - 1]] = new Node(x);
+        size_++;
+
+        while (k >= 3 && Red(pa[k - 1])) {
+            auto side = da[k - 2];
+            auto* g = As_node(pa[k - 2]);
+            auto* uncle = g->sons[1 - side];
+
+            if (Red(uncle)) {
+                As_node(pa[k - 1])->red = false;
+                As_node(uncle)->red = false;
+                g->red = true;
+                k -= 2;
+
+                continue;
+            }
+
+            Links* y = pa[k - 1];
+
+            if (da[k - 1] != side) {
+                auto* p = pa[k - 1];
+                y = p->sons[1 - side];
+                p->sons[1 - side] = y->sons[side];
+                y->sons[side] = p;
+                g->sons[side] = y;
+            }
+
+            g->red = true;
+            As_node(y)->red = false;
+            g->sons[side] = y->sons[1 - side];
+            y->sons[1 - side] = g;
+            pa[k - 3]->sons[da[k - 3]] = y;
+
+            break;
+        }
+
+        Root()->red = false;
+
+        return true;
+    }
+
+    // A node with two sons is swapped (links and color, never the key) with its successor, then the
+    // removed black is pushed up the stack until a red node absorbs it or the root is reached
+    template <typename T>
+    inline bool CompactRBTree<T>::remove(key_ref_t x) {
+        std::array<Links*, max_height + 2> pa;
+        std::array<int, max_height + 2> da;
+        std::size_t k = 1;
+        auto* p = Root();
+
+        pa[0] = &head_;
+        da[0] = 0;
+
+        for (;;) {
+            if (p == nullptr) return false;
+            if (!(x < p->key) && !(p->key < x)) break;
+
+            pa[k] = p;
+            da[k++] = (p->key < x ? 1 : 0);
+            p = As_node(p->sons[da[k - 1]]);
+        }
+
+        if (p->sons[1] == nullptr) pa[k - 1]->sons[da[k - 1]] = p->sons[0];
+        else {
+            auto* r = As_node(p->sons[1]);
+
+            if (r->sons[0] == nullptr) {
+                r->sons[0] = p->sons[0];
+                std::swap(r->red, p->red);
+                pa[k - 1]->sons[da[k - 1]] = r;
+                pa[k] = r;
+                da[k++] = 1;
+            }
+            else {
+                auto j = k++;
+                node_ptr_t s;
+
+                for (;;) {
+                    pa[k] = r;
+                    da[k++] = 0;
+                    s = As_node(r->sons[0]);
+
+                    if (s->sons[0] == nullptr) break;
+
+                    r = s;
+                }
+
+                pa[j] = s;
+                da[j] = 1;
+                pa[j - 1]->sons[da[j - 1]] = s;
+                s->sons[0] = p->sons[0];
+                r->sons[0] = s->sons[1];
+                s->sons[1] = p->sons[1];
+                std::swap(s->red, p->red);
+            }
+        }
+
+        if (!p->red) {
+            for (; k >= 2; --k) {
+                auto d = da[k - 1];
+                auto* f = As_node(pa[k - 1]);
+                auto* q = f->sons[d];
+
+                if (Red(q)) {
+                    As_node(q)->red = false;
+
+                    break;
+                }
+
+                auto* w = As_node(f->sons[1 - d]);
+
+                if (w->red) {
+                    w->red = false;
+                    f->red = true;
+                    f->sons[1 - d] = w->sons[d];
+                    w->sons[d] = f;
+                    pa[k - 2]->sons[da[k - 2]] = w;
+                    pa[k] = f;
+                    da[k] = d;
+                    pa[k - 1] = w;
+                    k++;
+                    w = As_node(f->sons[1 - d]);
+                }
+
+                if (!Red(w->sons[0]) && !Red(w->sons[1])) w->red = true;
+                else {
+                    if (!Red(w->sons[1 - d])) {
+                        auto* y = As_node(w->sons[d]);
+                        y->red = false;
+                        w->red = true;
+                        w->sons[d] = y->sons[1 - d];
+                        y->sons[1 - d] = w;
+                        f->sons[1 - d] = y;
+                        w = y;
+                    }
+
+                    w->red = f->red;
+                    f->red = false;
+                    As_node(w->sons[1 - d])->red = false;
+                    f->sons[1 - d] = w->sons[d];
+                    w->sons[d] = f;
+                    pa[k - 2]->sons[da[k - 2]] = w;
+
+                    break;
+                }
+            }
+
+            if (k < 2 && Root() != nullptr) Root()->red = false;
+        }
+
+        delete p;
+        size_--;
+
+        return true;
+    }
+
+}
+
+#endif
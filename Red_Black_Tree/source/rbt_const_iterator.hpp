@@ -3,75 +3,73 @@
 
 #pragma once
 
+#include <cstddef>
 #include "rbt_node.hpp"
 
 namespace ads::ds::rbt::iterators {
 
-    template <typename T>
+    // Root is the root slot of the tree the iterator came from, end() steps back to the biggest key through it
+    template <typename T, typename Aug = ads::ds::rbt::augment::NoAugmentation, typename Stats = ads::ds::rbt::stats::NoStats>
     class ConstIterator {
     protected:
-        ads::ds::rbt::node_impl::RBNode<T>* Iter;
+        ads::ds::rbt::node_impl::RBNode<T, Aug>*        Iter;
+        ads::ds::rbt::node_impl::RBNode<T, Aug>* const* Root;
 
     public:
-        typedef ConstIterator             self_type;
-        typedef T                         value_type;
-        typedef T&                        reference;
-        typedef T*                        pointer;
-        typedef std::forward_iterator_tag iterator_category;
-        typedef int                       difference_type;
-
-        ConstIterator()                                                 : Iter{ nullptr } {};
-        explicit ConstIterator(ads::ds::rbt::node_impl::RBNode<T>* ptr) : Iter{ ptr } {};
-        ConstIterator(const ConstIterator& s)                           : Iter{ s.Iter } {};
-        ConstIterator(const ConstIterator&& s) noexcept                 : Iter{ s.Iter } {};
-
-        ads::ds::rbt::node_impl::RBNode<T>* getIter() { return Iter; };
-
-        ConstIterator       operator++                                        ();
-        const ConstIterator operator++                                        (int);
-        ConstIterator       operator--                                        ();
-        const ConstIterator operator--                                        (int);
-        ConstIterator&      operator=                                         (const ConstIterator& source)       { if (this != &source) { this->Iter = source.Iter; } return (*this); };
-        ConstIterator&      operator=                                         (ConstIterator&& source)   noexcept { this->Iter = source.Iter; return (*this); };
+        typedef ConstIterator                   self_type;
+        typedef T                               value_type;
+        typedef const T&                        reference;
+        typedef const T*                        pointer;
+        typedef std::bidirectional_iterator_tag iterator_category;
+        typedef std::ptrdiff_t                  difference_type;
+
+        ConstIterator()                                                 : Iter{ nullptr }, Root{ nullptr } {};
+        explicit ConstIterator(ads::ds::rbt::node_impl::RBNode<T, Aug>* ptr, ads::ds::rbt::node_impl::RBNode<T, Aug>* const* root = nullptr) : Iter{ ptr }, Root{ root } {};
+        ConstIterator(const ConstIterator& s)                           : Iter{ s.Iter }, Root{ s.Root } {};
+        ConstIterator(const ConstIterator&& s) noexcept                 : Iter{ s.Iter }, Root{ s.Root } {};
+
+        ads::ds::rbt::node_impl::RBNode<T, Aug>* getIter() { return Iter; };
+
+        ConstIterator&      operator++                                        ();
+        ConstIterator       operator++                                        (int);
+        ConstIterator&      operator--                                        ();
+        ConstIterator       operator--                                        (int);
+        ConstIterator&      operator=                                         (const ConstIterator& source)       { if (this != &source) { this->Iter = source.Iter; this->Root = source.Root; } return (*this); };
+        ConstIterator&      operator=                                         (ConstIterator&& source)   noexcept { this->Iter = source.Iter; this->Root = source.Root; return (*this); };
         bool                operator==                                        (const ConstIterator& source) const { return (Iter == source.Iter); };
         bool                operator!=                                        (const ConstIterator& source) const { return (Iter != source.Iter); };
-        explicit            operator ads::ds::rbt::node_impl::RBNode<T>&      ()                                  { return (*Iter); };
-        explicit            operator const ads::ds::rbt::node_impl::RBNode<T>&()                            const { return (*Iter); };
-        T const&            operator*                                         ()                            const { return (Iter->key); };
-        ads::ds::rbt::node_impl::RBNode<T>* const* operator->                 ()                            const { return Iter; };
+        explicit            operator ads::ds::rbt::node_impl::RBNode<T, Aug>&      ()                                  { return (*Iter); };
+        explicit            operator const ads::ds::rbt::node_impl::RBNode<T, Aug>&()                            const { return (*Iter); };
+        reference           operator*                                         ()                            const { return (Iter->key); };
+        const ads::ds::rbt::node_impl::RBNode<T, Aug>* operator->                  ()                            const { return Iter; };
         explicit            operator bool()                                                                 const { return (Iter != nullptr); };
     };
 
-    template <typename T>
-    ConstIterator<T> ConstIterator<T>::operator++() {
-        if (this->Iter != nullptr) {
-            this->Iter = this->Iter->node_Successor();
+    template <typename T, typename Aug, typename Stats>
+    ConstIterator<T, Aug, Stats>& ConstIterator<T, Aug, Stats>::operator++() {
+        if (this->Iter != nullptr) this->Iter = ads::ds::rbt::node_impl::successor_of<Stats>(this->Iter);
 
-            return *this;
-        }
-        else return *this;
+        return *this;
     }
 
-    template <typename T>
-    const ConstIterator<T> ConstIterator<T>::operator++(int) {
+    template <typename T, typename Aug, typename Stats>
+    ConstIterator<T, Aug, Stats> ConstIterator<T, Aug, Stats>::operator++(int) {
         ConstIterator pom = *this;
         ++(*this);
 
         return pom;
     }
 
-    template <typename T>
-    ConstIterator<T> ConstIterator<T>::operator--() {
-        if (this->Iter != nullptr) {
-            this->Iter = this->Iter->node_Predecessor();
+    template <typename T, typename Aug, typename Stats>
+    ConstIterator<T, Aug, Stats>& ConstIterator<T, Aug, Stats>::operator--() {
+        if (this->Iter != nullptr) this->Iter = ads::ds::rbt::node_impl::predecessor_of<Stats>(this->Iter);
+        else if (this->Root != nullptr && *this->Root != nullptr) this->Iter = (*this->Root)->max_node();
 
-            return *this;
-        }
-        else return *this;
+        return *this;
     }
 
-    template <typename T>
-    const ConstIterator<T> ConstIterator<T>::ConstIterator::operator--(int) {
+    template <typename T, typename Aug, typename Stats>
+    ConstIterator<T, Aug, Stats> ConstIterator<T, Aug, Stats>::operator--(int) {
         ConstIterator pom = *this;
         --(*this);
 
@@ -80,4 +78,4 @@ namespace ads::ds::rbt::iterators {
 
 }
 
-#endif
\ No newline at end of file
+#endif
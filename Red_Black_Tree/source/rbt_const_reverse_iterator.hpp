@@ -7,10 +7,10 @@
 
 namespace ads::ds::rbt::iterators {
 
-    template <typename T>
+    template <typename T, typename Aug = ads::ds::rbt::augment::NoAugmentation, typename Stats = ads::ds::rbt::stats::NoStats>
     class ConstReverseIterator {
     protected:
-        ads::ds::rbt::node_impl::RBNode<T>* Iter;
+        ads::ds::rbt::node_impl::RBNode<T, Aug>* Iter;
 
     public:
         typedef ConstReverseIterator      self_type;
@@ -21,11 +21,11 @@ namespace ads::ds::rbt::iterators {
         typedef int                       difference_type;
 
         ConstReverseIterator()                                                 : Iter{ nullptr } {};
-        explicit ConstReverseIterator(ads::ds::rbt::node_impl::RBNode<T>* ptr) : Iter{ ptr } {};
+        explicit ConstReverseIterator(ads::ds::rbt::node_impl::RBNode<T, Aug>* ptr) : Iter{ ptr } {};
         ConstReverseIterator(const ConstReverseIterator& s)                    : Iter{ s.Iter } {};
         ConstReverseIterator(const ConstReverseIterator&& s) noexcept          : Iter{ s.Iter } {};
 
-        inline ads::ds::rbt::node_impl::RBNode<T>* getIter() { return Iter; };
+        inline ads::ds::rbt::node_impl::RBNode<T, Aug>* getIter() { return Iter; };
 
         ConstReverseIterator       operator++                                         ();
         const ConstReverseIterator operator++                                         (int);
@@ -35,43 +35,43 @@ namespace ads::ds::rbt::iterators {
         ConstReverseIterator&      operator=                                          (ConstReverseIterator&& source)   noexcept { this->Iter = source.Iter; return (*this); };
         bool                       operator==                                         (const ConstReverseIterator& source) const { return (Iter == source.Iter); };
         bool                       operator!=                                         (const ConstReverseIterator& source) const { return (Iter != source.Iter); };
-        explicit                   operator ads::ds::rbt::node_impl::RBNode<T>&       ()                                         { return (*Iter); };
-        explicit                   operator const ads::ds::rbt::node_impl::RBNode<T>& ()                                   const { return (*Iter); };
+        explicit                   operator ads::ds::rbt::node_impl::RBNode<T, Aug>&       ()                                         { return (*Iter); };
+        explicit                   operator const ads::ds::rbt::node_impl::RBNode<T, Aug>& ()                                   const { return (*Iter); };
         T const&                   operator*                                          ()                                   const { return (Iter->key); };
-        ads::ds::rbt::node_impl::RBNode<T> const* operator->                          ()                                   const { return Iter; };
+        ads::ds::rbt::node_impl::RBNode<T, Aug> const* operator->                          ()                                   const { return Iter; };
         explicit                   operator bool()                                                                         const { return (Iter != nullptr); };
     };
 
-    template <typename T>
-    ConstReverseIterator<T> ConstReverseIterator<T>::operator++() {
+    template <typename T, typename Aug, typename Stats>
+    ConstReverseIterator<T, Aug, Stats> ConstReverseIterator<T, Aug, Stats>::operator++() {
         if (this->Iter != nullptr) {
-            this->Iter = this->Iter->node_Predecessor();
+            this->Iter = ads::ds::rbt::node_impl::predecessor_of<Stats>(this->Iter);
 
             return *this;
         }
         else return *this;
     }
 
-    template <typename T>
-    const ConstReverseIterator<T> ConstReverseIterator<T>::operator++(int) {
+    template <typename T, typename Aug, typename Stats>
+    const ConstReverseIterator<T, Aug, Stats> ConstReverseIterator<T, Aug, Stats>::operator++(int) {
         ConstReverseIterator pom = *this;
         ++(*this);
 
         return pom;
     }
 
-    template <typename T>
-    ConstReverseIterator<T> ConstReverseIterator<T>::operator--() {
+    template <typename T, typename Aug, typename Stats>
+    ConstReverseIterator<T, Aug, Stats> ConstReverseIterator<T, Aug, Stats>::operator--() {
         if (this->Iter != nullptr) {
-            this->Iter = this->Iter->node_Successor();
+            this->Iter = ads::ds::rbt::node_impl::successor_of<Stats>(this->Iter);
 
             return *this;
         }
         else return *this;
     }
 
-    template <typename T>
-    const ConstReverseIterator<T> ConstReverseIterator<T>::operator--(int) {
+    template <typename T, typename Aug, typename Stats>
+    const ConstReverseIterator<T, Aug, Stats> ConstReverseIterator<T, Aug, Stats>::operator--(int) {
         ConstReverseIterator pom = *this;
         --(*this);
 
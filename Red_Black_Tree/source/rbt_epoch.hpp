@@ -0,0 +1,114 @@
+#ifndef RBTREE_RBT_EPOCH_HPP
+#define RBTREE_RBT_EPOCH_HPP
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include "exceptions.hpp"
+
+namespace ads::ds::rbt::reclamation {
+
+    /**
+        * Epoch based reclamation domain
+        * Readers pin the global epoch into their own slot for the duration of a read, the writer tags
+        * every unlinked node with the epoch of its unlinking and may free it once no pinned slot is older.
+        * Slots live on separate cache lines so readers never write to a shared line.
+    */
+    class EpochDomain {
+    public:
+        typedef std::uint64_t epoch_t;
+
+        static constexpr std::size_t max_readers = 128;
+        static constexpr epoch_t     idle        = std::numeric_limits<epoch_t>::max();
+
+        class Guard;
+
+        EpochDomain()                              : global_{ 0 } {};
+        EpochDomain(const EpochDomain&)            = delete;
+        EpochDomain& operator=(const EpochDomain&) = delete;
+        ~EpochDomain()                             = default;
+
+        std::size_t acquire_slot(std::size_t hint = 0);
+        void        release_slot(std::size_t);
+        void        pin(std::size_t);
+        void        unpin(std::size_t);
+        epoch_t     advance();
+        epoch_t     oldest_pinned() const;
+
+    private:
+        struct alignas(64) Slot {
+            std::atomic<epoch_t> epoch{ idle };
+            std::atomic<bool>    used{ false };
+        };
+
+        alignas(64) std::atomic<epoch_t> global_;
+        Slot                             slots_[max_readers];
+    };
+
+    // Keeps the epoch pinned while alive, one guard per read operation
+    class EpochDomain::Guard {
+    public:
+        Guard(EpochDomain& domain, std::size_t slot) : domain_{ domain }, slot_{ slot } { domain_.pin(slot_); };
+        Guard(const Guard&)            = delete;
+        Guard& operator=(const Guard&) = delete;
+        ~Guard()                                                                         { domain_.unpin(slot_); };
+
+    private:
+        EpochDomain& domain_;
+        std::size_t  slot_;
+    };
+
+    // The scan starts at hint, threads passing different hints (a hash of their id) do not meet on one slot
+    inline std::size_t EpochDomain::acquire_slot(std::size_t hint) {
+        for (std::size_t k = 0; k < max_readers; ++k) {
+            auto i = (hint + k) % max_readers;
+            auto expected = false;
+
+            if (!slots_[i].used.load(std::memory_order_relaxed) &&
+                slots_[i].used.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                return i;
+            }
+        }
+
+        throw ads::ds::rbt::exception::TooManyReadersException();
+    }
+
+    inline void EpochDomain::release_slot(std::size_t slot) {
+        slots_[slot].epoch.store(idle, std::memory_order_relaxed);
+        slots_[slot].used.store(false, std::memory_order_release);
+    }
+
+    inline void EpochDomain::pin(std::size_t slot) {
+        slots_[slot].epoch.store(global_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        // Pairs with the fence in oldest_pinned(): either the writer sees this pin or we see its unlink
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    inline void EpochDomain::unpin(std::size_t slot) {
+        slots_[slot].epoch.store(idle, std::memory_order_release);
+    }
+
+    // Returns the epoch the already unlinked nodes belong to
+    inline EpochDomain::epoch_t EpochDomain::advance() {
+        return global_.fetch_add(1, std::memory_order_acq_rel);
+    }
+
+    inline EpochDomain::epoch_t EpochDomain::oldest_pinned() const {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        auto oldest = idle;
+
+        for (const auto& slot : slots_) {
+            auto e = slot.epoch.load(std::memory_order_acquire);
+
+            if (e < oldest) oldest = e;
+        }
+
+        return oldest;
+    }
+
+}
+
+#endif
@@ -0,0 +1,202 @@
+#ifndef RBTREE_RBT_FIXUP_HPP
+#define RBTREE_RBT_FIXUP_HPP
+
+#pragma once
+
+#include "rbt_stats.hpp"
+
+namespace ads::ds::rbt::fixup {
+
+    /**
+        * Red-black rebalancing shared by the trees of the library
+        * Written once for side d and its mirror 1 - d over a Links adaptor, so pointer nodes, pool indices
+        * and buckets run the same Insert_fix and Delete_fix and a fix lands in one place.
+        * Links members:
+        *   handle_t, nil                        - node reference and the missing node
+        *   root(), son(n, d), father(n)         - d 0 left, 1 right
+        *   red(n), paint(n, red)                - red(nil) is false
+        *   rotate(n, d)                         - moves n down to side d, returns the node now in the lower place
+        *                                          (n itself unless the tree rotates a copy)
+        *   set_root(n), set_son(n, d, s), set_father(n, f)
+        *                                        - only needed by rotate(), transplant() and unlink() below
+        *   step(event)                          - optional, told of every fixup loop iteration (Stats)
+    */
+
+    template <typename Links>
+    inline int side(const Links& l, typename Links::handle_t f, typename Links::handle_t s) {
+        return (l.son(f, 0) == s ? 0 : 1);
+    }
+
+    // Outermost node on side d of the subtree of n
+    template <typename Links>
+    inline typename Links::handle_t outer(const Links& l, typename Links::handle_t n, int d) {
+        if (n == Links::nil) return n;
+
+        while (l.son(n, d) != Links::nil) n = l.son(n, d);
+
+        return n;
+    }
+
+    template <typename Links>
+    inline void step(Links& l, ads::ds::rbt::stats::event e) {
+        if constexpr (requires { l.step(e); }) l.step(e);
+    }
+
+    // Moves n down to side d, its son on the other side takes its place
+    template <typename Links>
+    inline typename Links::handle_t rotate(Links& l, typename Links::handle_t n, int d) {
+        auto y = l.son(n, 1 - d);
+        auto b = l.son(y, d);
+        auto f = l.father(n);
+
+        l.set_son(n, 1 - d, b);
+
+        if (b != Links::nil) l.set_father(b, n);
+
+        l.set_father(y, f);
+
+        if (f == Links::nil) l.set_root(y);
+        else l.set_son(f, side(l, f, n), y);
+
+        l.set_son(y, d, n);
+        l.set_father(n, y);
+
+        return n;
+    }
+
+    template <typename Links>
+    inline void transplant(Links& l, typename Links::handle_t u, typename Links::handle_t v) {
+        auto f = l.father(u);
+
+        if (f == Links::nil) l.set_root(v);
+        else l.set_son(f, side(l, f, u), v);
+
+        if (v != Links::nil) l.set_father(v, f);
+    }
+
+    // Returns true when the root had to be repainted black, i.e. the black height of the tree grew
+    template <typename Links>
+    inline bool insert_fix(Links& l, typename Links::handle_t x) {
+        while (x != l.root() && l.red(l.father(x))) {
+            step(l, ads::ds::rbt::stats::insert_fix_step);
+
+            auto f = l.father(x);
+            auto g = l.father(f);
+            auto d = side(l, g, f);
+            auto y = l.son(g, 1 - d);
+
+            if (l.red(y)) {
+                l.paint(f, false);
+                l.paint(y, false);
+                l.paint(g, true);
+                x = g;
+            }
+            else {
+                if (x == l.son(f, 1 - d)) {
+                    x = l.rotate(f, d);
+                    f = l.father(x);
+                }
+
+                l.paint(f, false);
+                l.paint(g, true);
+                l.rotate(g, 1 - d);
+            }
+        }
+
+        auto grew = l.red(l.root());
+        l.paint(l.root(), false);
+
+        return grew;
+    }
+
+    // Missing sons count as black leaves, so the father of p is tracked separately
+    template <typename Links>
+    inline void delete_fix(Links& l, typename Links::handle_t p, typename Links::handle_t f) {
+        while (p != l.root() && !l.red(p)) {
+            step(l, ads::ds::rbt::stats::delete_fix_step);
+
+            auto d = side(l, f, p);
+            auto s = l.son(f, 1 - d);
+
+            if (l.red(s)) {
+                l.paint(s, false);
+                l.paint(f, true);
+                f = l.rotate(f, d);
+                s = l.son(f, 1 - d);
+            }
+
+            if (!l.red(l.son(s, 0)) && !l.red(l.son(s, 1))) {
+                l.paint(s, true);
+                p = f;
+                f = l.father(p);
+            }
+            else {
+                if (!l.red(l.son(s, 1 - d))) {
+                    l.paint(l.son(s, d), false);
+                    l.paint(s, true);
+                    l.rotate(s, 1 - d);
+                    s = l.son(f, 1 - d);
+                }
+
+                l.paint(s, l.red(f));
+                l.paint(f, false);
+                l.paint(l.son(s, 1 - d), false);
+                l.rotate(f, d);
+                p = l.root();
+            }
+        }
+
+        if (p != Links::nil) l.paint(p, false);
+    }
+
+    template <typename Handle>
+    struct Unlinked {
+        Handle son;       // took the place of the node spliced out, may be nil
+        Handle father;    // of son
+        bool   red;       // color of the node spliced out, delete_fix is due when black
+    };
+
+    // Relinks the successor into the place of a node with two sons, keys never move between nodes
+    template <typename Links>
+    inline Unlinked<typename Links::handle_t> unlink(Links& l, typename Links::handle_t p) {
+        Unlinked<typename Links::handle_t> out{ Links::nil, Links::nil, l.red(p) };
+
+        if (l.son(p, 0) == Links::nil || l.son(p, 1) == Links::nil) {
+            out.son = l.son(p, l.son(p, 0) == Links::nil ? 1 : 0);
+            out.father = l.father(p);
+            transplant(l, p, out.son);
+
+            return out;
+        }
+
+        auto y = outer(l, l.son(p, 1), 0);
+        out.red = l.red(y);
+        out.son = l.son(y, 1);
+
+        if (l.father(y) == p) out.father = y;
+        else {
+            out.father = l.father(y);
+            transplant(l, y, out.son);
+            l.set_son(y, 1, l.son(p, 1));
+            l.set_father(l.son(y, 1), y);
+        }
+
+        transplant(l, p, y);
+        l.set_son(y, 0, l.son(p, 0));
+        l.set_father(l.son(y, 0), y);
+        l.paint(y, l.red(p));
+
+        return out;
+    }
+
+    // Unlinks p and restores the colors
+    template <typename Links>
+    inline void erase(Links& l, typename Links::handle_t p) {
+        auto out = unlink(l, p);
+
+        if (!out.red) delete_fix(l, out.son, out.father);
+    }
+
+}
+
+#endif
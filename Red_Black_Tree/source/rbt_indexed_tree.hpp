@@ -0,0 +1,301 @@
+#ifndef RBTREE_RBT_INDEXED_TREE_HPP
+#define RBTREE_RBT_INDEXED_TREE_HPP
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iostream>
+#include <iterator>
+#include <vector>
+#include "exceptions.hpp"
+#include "rbt_fixup.hpp"
+
+namespace ads::ds::rbt {
+
+    /**
+        * Red-Black Tree in one contiguous pool with 32-bit links
+        * Nodes live in a vector and link to each other by uint32_t index, npos for none, so RBTree<int>'s
+        * 40 byte node shrinks to 20 bytes. Nothing in the pool is an address: the tree copies as one block
+        * (a memcpy when T is trivially copyable), can be written out or shared as is and stays valid
+        * wherever it is moved. Erased slots are chained into a free list and reused, shrink_to_fit()
+        * lays the nodes out again in breadth first order without holes.
+        * Up to 2^32 - 1 nodes, iterators hold the tree and an index.
+    */
+    template <typename T>
+    class IndexedRBTree {
+    public:
+        typedef std::uint32_t index_t;
+
+        struct Node {
+            T            key;
+            index_t      sons[2];     // 0 left, 1 right
+            index_t      father;
+            std::uint8_t red;
+        };
+
+        class const_iterator;
+
+        typedef T                 key_t;
+        typedef const T&          key_ref_t;
+        typedef Node              node_t;
+        typedef IndexedRBTree<T>  self_type;
+        typedef const_iterator    iterator;
+
+        static constexpr index_t     npos      = ~index_t{ 0 };
+        static constexpr std::size_t max_nodes = npos;
+
+        IndexedRBTree()                              : root_{ npos }, free_{ npos }, size_{ 0 } {};
+        IndexedRBTree(std::initializer_list<T> init) : root_{ npos }, free_{ npos }, size_{ 0 } { for (auto& e : init) insert(e); };
+
+        std::size_t              size()       const noexcept { return size_; };
+        [[nodiscard]] bool       isEmpty()    const noexcept { return size_ == 0; };
+        std::size_t              capacity()   const noexcept { return pool_.capacity(); };
+        index_t                  root_index() const noexcept { return root_; };
+        const std::vector<Node>& nodes()      const noexcept { return pool_; };
+        const Node&              node(index_t i) const       { return pool_[i]; };
+        void                     reserve(std::size_t n)      { pool_.reserve(n); };
+        void                     clear() noexcept            { pool_.clear(); root_ = npos; free_ = npos; size_ = 0; };
+        void                     shrink_to_fit();
+        bool                     insert(key_ref_t);
+        bool                     remove(key_ref_t);
+        std::size_t              erase(key_ref_t x)          { return remove(x) ? 1 : 0; };
+        bool                     find(key_ref_t x) const     { return Find(x) != npos; };
+        const_iterator           lower_bound(key_ref_t) const;
+        const_iterator           upper_bound(key_ref_t) const;
+        const_iterator           begin()  const              { return const_iterator(this, Outer(root_, 0)); };
+        const_iterator           end()    const              { return const_iterator(this, npos); };
+        const_iterator           cbegin() const              { return begin(); };
+        const_iterator           cend()   const              { return end(); };
+
+        friend std::ostream& operator<<(std::ostream& ofs, const self_type& tree) {
+            for (auto it = tree.cbegin(); it != tree.cend(); ++it) ofs << *it << ", ";
+
+            ofs << "\n";
+
+            return ofs;
+        }
+
+    private:
+        // Link access for the shared red-black fixups (rbt_fixup.hpp), Tree is const for reading only
+        template <typename Tree>
+        struct Links {
+            typedef index_t handle_t;
+
+            static constexpr index_t nil = npos;
+
+            Tree& t;
+
+            index_t root()                             const { return t.root_; };
+            index_t son(index_t i, int d)              const { return t.pool_[i].sons[d]; };
+            index_t father(index_t i)                  const { return t.pool_[i].father; };
+            bool    red(index_t i)                     const { return i != npos && t.pool_[i].red != 0; };
+            void    paint(index_t i, bool red)               { t.pool_[i].red = (red ? 1 : 0); };
+            index_t rotate(index_t i, int d)                 { return ads::ds::rbt::fixup::rotate(*this, i, d); };
+            void    set_root(index_t i)                      { t.root_ = i; };
+            void    set_son(index_t i, int d, index_t s)     { t.pool_[i].sons[d] = s; };
+            void    set_father(index_t i, index_t f)         { t.pool_[i].father = f; };
+        };
+
+        index_t        Outer(index_t i, int d) const { return ads::ds::rbt::fixup::outer(Links<const self_type>{ *this }, i, d); };
+        index_t        Next(index_t, int) const;
+        index_t        Find(key_ref_t) const;
+        index_t        Allocate(key_ref_t);
+        void           Release(index_t);
+
+        std::vector<Node> pool_;
+        index_t           root_;
+        index_t           free_;
+        std::size_t       size_;
+    };
+
+    template <typename T>
+    class IndexedRBTree<T>::const_iterator {
+    public:
+        typedef std::bidirectional_iterator_tag iterator_category;
+        typedef T                               value_type;
+        typedef std::ptrdiff_t                  difference_type;
+        typedef const T*                        pointer;
+        typedef const T&                        reference;
+
+        const_iterator()                                          : tree_{ nullptr }, at_{ npos } {};
+        const_iterator(const IndexedRBTree* tree, index_t at)     : tree_{ tree }, at_{ at } {};
+
+        reference       operator*()  const                        { return tree_->pool_[at_].key; };
+        pointer         operator->() const                        { return &tree_->pool_[at_].key; };
+        const_iterator& operator++()                              { at_ = tree_->Next(at_, 1); return *this; };
+        const_iterator  operator++(int)                           { auto old = *this; ++(*this); return old; };
+        const_iterator& operator--()                              { at_ = (at_ == npos ? tree_->Outer(tree_->root_, 1) : tree_->Next(at_, 0)); return *this; };
+        const_iterator  operator--(int)                           { auto old = *this; --(*this); return old; };
+        bool            operator==(const const_iterator& s) const { return at_ == s.at_; };
+        bool            operator!=(const const_iterator& s) const { return at_ != s.at_; };
+        explicit        operator bool() const                     { return at_ != npos; };
+        index_t         index() const                             { return at_; };
+
+    private:
+        const IndexedRBTree* tree_;
+        index_t              at_;
+    };
+
+    // Next key for d = 1, previous one for d = 0
+    template <typename T>
+    inline typename IndexedRBTree<T>::index_t IndexedRBTree<T>::Next(index_t i, int d) const {
+        if (pool_[i].sons[d] != npos) return Outer(pool_[i].sons[d], 1 - d);
+
+        auto f = pool_[i].father;
+
+        while (f != npos && pool_[f].sons[d] == i) {
+            i = f;
+            f = pool_[f].father;
+        }
+
+        return f;
+    }
+
+    template <typename T>
+    inline typename IndexedRBTree<T>::index_t IndexedRBTree<T>::Find(key_ref_t x) const {
+        auto p = root_;
+
+        while (p != npos) {
+            if (x < pool_[p].key) p = pool_[p].sons[0];
+            else if (pool_[p].key < x) p = pool_[p].sons[1];
+            else return p;
+        }
+
+        return npos;
+    }
+
+    template <typename T>
+    inline typename IndexedRBTree<T>::const_iterator IndexedRBTree<T>::lower_bound(key_ref_t x) const {
+        auto p = root_;
+        auto best = npos;
+
+        while (p != npos) {
+            if (pool_[p].key < x) p = pool_[p].sons[1];
+            else {
+                best = p;
+                p = pool_[p].sons[0];
+            }
+        }
+
+        return const_iterator(this, best);
+    }
+
+    template <typename T>
+    inline typename IndexedRBTree<T>::const_iterator IndexedRBTree<T>::upper_bound(key_ref_t x) const {
+        auto p = root_;
+        auto best = npos;
+
+        while (p != npos) {
+            if (x < pool_[p].key) {
+                best = p;
+                p = pool_[p].sons[0];
+            }
+            else p = pool_[p].sons[1];
+        }
+
+        return const_iterator(this, best);
+    }
+
+    // Reuses a slot of the free list (chained through sons[0]) before growing the pool
+    template <typename T>
+    inline typename IndexedRBTree<T>::index_t IndexedRBTree<T>::Allocate(key_ref_t x) {
+        if (free_ != npos) {
+            auto i = free_;
+            free_ = pool_[i].sons[0];
+            pool_[i] = Node{ x, { npos, npos }, npos, 1 };
+
+            return i;
+        }
+
+        if (pool_.size() >= max_nodes) throw ads::ds::rbt::exception::TreeCapacityException();
+
+        pool_.push_back(Node{ x, { npos, npos }, npos, 1 });
+
+        return static_cast<index_t>(pool_.size() - 1);
+    }
+
+    template <typename T>
+    inline void IndexedRBTree<T>::Release(index_t i) {
+        pool_[i].sons[0] = free_;
+        pool_[i].sons[1] = npos;
+        pool_[i].father = npos;
+        free_ = i;
+    }
+
+    // The pool may grow (and move) while the key is placed, so only indices are kept across Allocate
+    template <typename T>
+    inline bool IndexedRBTree<T>::insert(key_ref_t x) {
+        auto q = npos;
+        auto p = root_;
+        auto d = 0;
+
+        while (p != npos) {
+            q = p;
+
+            if (x < pool_[p].key) d = 0;
+            else if (pool_[p].key < x) d = 1;
+            else return false;
+
+            p = pool_[p].sons[d];
+        }
+
+        auto create = Allocate(x);
+        pool_[create].father = q;
+
+        if (q == npos) root_ = create;
+        else pool_[q].sons[d] = create;
+
+        size_++;
+
+        Links<self_type> links{ *this };
+        ads::ds::rbt::fixup::insert_fix(links, create);
+
+        return true;
+    }
+
+    template <typename T>
+    inline bool IndexedRBTree<T>::remove(key_ref_t x) {
+        auto p = Find(x);
+
+        if (p == npos) return false;
+
+        Links<self_type> links{ *this };
+        ads::ds::rbt::fixup::erase(links, p);
+
+        Release(p);
+        size_--;
+
+        return true;
+    }
+
+    // Copies the live nodes into a new pool in breadth first order, the top levels end up side by side
+    template <typename T>
+    inline void IndexedRBTree<T>::shrink_to_fit() {
+        std::vector<Node> packed;
+        packed.reserve(size_);
+
+        if (root_ != npos) {
+            packed.push_back(pool_[root_]);
+            packed[0].father = npos;
+        }
+
+        for (std::size_t at = 0; at < packed.size(); ++at) {
+            for (auto d : { 0, 1 }) {
+                if (auto son = packed[at].sons[d]; son != npos) {
+                    packed[at].sons[d] = static_cast<index_t>(packed.size());
+                    packed.push_back(pool_[son]);
+                    packed.back().father = static_cast<index_t>(at);
+                }
+            }
+        }
+
+        pool_ = std::move(packed);
+        root_ = (size_ == 0 ? npos : 0);
+        free_ = npos;
+    }
+
+}
+
+#endif
@@ -0,0 +1,165 @@
+#ifndef RBTREE_RBT_INTERVAL_TREE_HPP
+#define RBTREE_RBT_INTERVAL_TREE_HPP
+
+#pragma once
+
+#include "rb_tree.hpp"
+#include <optional>
+#include <vector>
+
+namespace ads::ds::rbt {
+
+    // Closed interval [low, high], ordered by low end first
+    template <typename T>
+    struct Interval {
+        T low;
+        T high;
+
+        bool overlaps(const T& a, const T& b) const { return !(b < low) && !(high < a); };
+        bool operator==(const Interval& s)    const { return low == s.low && high == s.high; };
+        bool operator!=(const Interval& s)    const { return !(*this == s); };
+        bool operator< (const Interval& s)    const { return low < s.low || (low == s.low && high < s.high); };
+        bool operator> (const Interval& s)    const { return s < *this; };
+        bool operator<=(const Interval& s)    const { return !(s < *this); };
+        bool operator>=(const Interval& s)    const { return !(*this < s); };
+
+        friend std::ostream& operator<<(std::ostream& ofs, const Interval& i) {
+            return ofs << "[" << i.low << ", " << i.high << "]";
+        };
+    };
+
+}
+
+namespace ads::ds::rbt::augment {
+
+    // Biggest high end in the subtree, empty for an empty subtree
+    template <typename T>
+    struct MaxEndpoint {
+        typedef std::optional<T> value_type;
+
+        static value_type lift(const ads::ds::rbt::Interval<T>& i)         { return i.high; };
+        static value_type identity()                                        { return std::nullopt; };
+        static value_type combine(const value_type& a, const value_type& b) { return (!a ? b : (!b ? a : (*a < *b ? b : a))); };
+    };
+
+}
+
+namespace ads::ds::rbt {
+
+    /**
+        * Interval tree
+        * An RBTree of intervals ordered by their low end, every node additionally knows the biggest high end
+        * of its subtree (MaxEndpoint augmentation, kept current by Rotate_left/Rotate_right). Any subtree whose
+        * biggest high end lies before the query, or whose low ends all lie after it, is skipped whole.
+        * Bounds given in either order mean the same interval, updates, lookups and queries swap them alike.
+    */
+    template <typename T>
+    class RBIntervalTree {
+    public:
+        typedef T                                                            key_t;
+        typedef const T&                                                     key_ref_t;
+        typedef ads::ds::rbt::Interval<T>                                    interval_t;
+        typedef ads::ds::rbt::RBTree<interval_t, augment::MaxEndpoint<T>>    tree_t;
+        typedef typename tree_t::node_ptr_t                                  node_ptr_t;
+        typedef typename tree_t::const_iterator                              const_iterator;
+
+        RBIntervalTree()  = default;
+        ~RBIntervalTree() = default;
+
+        bool                     insert(key_ref_t low, key_ref_t high);
+        bool                     remove(key_ref_t low, key_ref_t high);
+        bool                     contains(key_ref_t low, key_ref_t high);
+        void                     clear()                                   { tree_.clear(); };
+        std::size_t              size()                                    { return tree_.size(); };
+        [[nodiscard]] bool       isEmpty()                           const { return tree_.isEmpty(); };
+        bool                     any_overlap(key_ref_t a, key_ref_t b) const;
+        std::optional<interval_t> find_overlap(key_ref_t a, key_ref_t b) const;
+        template <typename F>
+        void                     for_each_overlapping(key_ref_t a, key_ref_t b, F f) const { auto q = Make(a, b); Overlapping(tree_.getRoot(), q.low, q.high, f); };
+        std::vector<interval_t>  overlapping(key_ref_t a, key_ref_t b) const;
+        std::vector<interval_t>  stabbing(key_ref_t x)                 const { return overlapping(x, x); };
+        const_iterator           begin()                               const { return tree_.cbegin(); };
+        const_iterator           end()                                 const { return tree_.cend(); };
+
+    private:
+        static interval_t Make(key_ref_t low, key_ref_t high) { return (high < low ? interval_t{ high, low } : interval_t{ low, high }); };
+        template <typename F>
+        static void Overlapping(node_ptr_t, key_ref_t, key_ref_t, F&);
+
+        tree_t tree_;
+    };
+
+    template <typename T>
+    inline bool RBIntervalTree<T>::insert(key_ref_t low, key_ref_t high) {
+        return static_cast<bool>(tree_.insert(Make(low, high)));
+    }
+
+    template <typename T>
+    inline bool RBIntervalTree<T>::remove(key_ref_t low, key_ref_t high) {
+        auto* p = tree_.node_find(Make(low, high));
+
+        if (p == nullptr) return false;
+
+        delete tree_.node_extract(p);
+
+        return true;
+    }
+
+    template <typename T>
+    inline bool RBIntervalTree<T>::contains(key_ref_t low, key_ref_t high) {
+        return tree_.node_find(Make(low, high)) != nullptr;
+    }
+
+    // One root to leaf walk: go left whenever the left subtree reaches far enough, otherwise nothing
+    // on the left can overlap and the answer, if any, is on the right
+    template <typename T>
+    inline std::optional<typename RBIntervalTree<T>::interval_t> RBIntervalTree<T>::find_overlap(key_ref_t a, key_ref_t b) const {
+        auto q = Make(a, b);
+        auto* n = tree_.getRoot();
+
+        while (n != nullptr && !n->key.overlaps(q.low, q.high)) {
+            if (n->left != nullptr && !(*n->left->aug < q.low)) n = n->left;
+            else n = n->right;
+        }
+
+        if (n == nullptr) return std::nullopt;
+
+        return n->key;
+    }
+
+    template <typename T>
+    inline bool RBIntervalTree<T>::any_overlap(key_ref_t a, key_ref_t b) const {
+        return find_overlap(a, b).has_value();
+    }
+
+    // Reports in order of low ends, pruning subtrees ending before a and right subtrees starting after b.
+    // O(min(n, k log n)) for k intervals reported: a subtree whose biggest high end reaches a may still hold
+    // no overlap below its top, so each reported interval can cost a descent of its own
+    template <typename T>
+    template <typename F>
+    inline void RBIntervalTree<T>::Overlapping(node_ptr_t n, key_ref_t a, key_ref_t b, F& f) {
+        while (n != nullptr && !(*n->aug < a)) {
+            Overlapping(n->left, a, b, f);
+
+            if (b < n->key.low) return;
+            if (n->key.overlaps(a, b)) f(n->key);
+
+            n = n->right;
+        }
+    }
+
+    template <typename T>
+    inline std::vector<typename RBIntervalTree<T>::interval_t> RBIntervalTree<T>::overlapping(key_ref_t a, key_ref_t b) const {
+        std::vector<interval_t> found;
+        auto collect = [&found](const interval_t& i) { found.push_back(i); };
+
+        auto q = Make(a, b);
+
+        Overlapping(tree_.getRoot(), q.low, q.high, collect);
+
+        return found;
+    }
+
+}
+
+#endif
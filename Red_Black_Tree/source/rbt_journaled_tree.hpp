@@ -0,0 +1,325 @@
+#ifndef RBTREE_RBT_JOURNALED_TREE_HPP
+#define RBTREE_RBT_JOURNALED_TREE_HPP
+
+#pragma once
+
+#include "rb_tree.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace ads::ds::rbt {
+
+    /**
+        * Red-Black Tree with an append only operation journal
+        * Every change that modified the tree is appended to <path>.journal as one record: operation byte
+        * followed by the key(s), in the same encoding as snapshots. Records are gathered in memory and
+        * written with one write + fdatasync per group_bytes (group commit), sync() forces the group out.
+        * checkpoint() saves the tree to <path>.snapshot and empties the journal, it runs by itself every
+        * checkpoint_every logged operations.
+        * Recovery loads the snapshot and replays the journal in batches. A replayed record sets the presence
+        * of its keys unconditionally (insert: present, remove: absent, replace: from absent and to present),
+        * so the last record of a key decides and replaying over a snapshot that already holds the records is
+        * idempotent: a crash between renaming the snapshot and emptying the journal is harmless. A torn
+        * record at the end of the journal is cut off.
+    */
+    template <typename T>
+    class JournaledRBTree {
+    public:
+        typedef T                                         key_t;
+        typedef const T&                                  key_ref_t;
+        typedef ads::ds::rbt::RBTree<T>                   tree_t;
+        typedef typename tree_t::const_iterator           const_iterator;
+        typedef JournaledRBTree<T>                        self_type;
+
+        enum class op_t : std::uint8_t { insert = 1, remove = 2, replace = 3 };
+
+        static constexpr std::size_t group_bytes  = std::size_t{ 1 } << 16;
+        static constexpr std::size_t replay_batch = std::size_t{ 1 } << 12;
+
+        explicit JournaledRBTree(std::string path, std::size_t checkpoint_every = std::size_t{ 1 } << 20);
+        JournaledRBTree(const JournaledRBTree&)            = delete;
+        JournaledRBTree& operator=(const JournaledRBTree&) = delete;
+        ~JournaledRBTree();
+
+        bool               insert(key_ref_t);
+        bool               remove(key_ref_t);
+        bool               replace(key_ref_t from, key_ref_t to);
+        bool               find(key_ref_t x) const { auto it = tree_.lower_bound(x); return it != tree_.cend() && !(x < *it); };
+        std::size_t        size()                  { return tree_.size(); };
+        [[nodiscard]] bool isEmpty()         const { return tree_.isEmpty(); };
+        const tree_t&      tree()            const { return tree_; };
+        std::size_t        logged()          const { return logged_; };
+        void               sync()                  { Commit(); };
+        void               checkpoint();
+        const_iterator     begin()           const { return tree_.cbegin(); };
+        const_iterator     end()             const { return tree_.cend(); };
+
+    private:
+        struct Record {
+            op_t op;
+            T    first;
+            T    second;
+        };
+
+        static void         Write_key(std::ostream&, key_ref_t);
+        static bool         Read_key(std::istream&, T&);
+        bool                Apply(const Record&);
+        void                Replay(const Record&);
+        void                Erase(key_ref_t);
+        static void         Sync_dir(const std::string&);
+        void                Log(op_t, key_ref_t, key_ref_t);
+        void                Commit();
+        void                Recover();
+
+        std::string         path_;
+        std::string         journal_;
+        std::string         snapshot_;
+        tree_t              tree_;
+        int                 fd_;
+        std::ostringstream  buffer_;
+        std::size_t         logged_;
+        std::size_t         checkpoint_every_;
+    };
+
+    template <typename T>
+    inline JournaledRBTree<T>::JournaledRBTree(std::string path, std::size_t checkpoint_every)
+        : path_{ std::move(path) }, fd_{ -1 }, buffer_{ std::ios::binary }, logged_{ 0 }, checkpoint_every_{ checkpoint_every } {
+        journal_ = path_ + ".journal";
+        snapshot_ = path_ + ".snapshot";
+
+        Recover();
+
+        fd_ = ::open(journal_.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+
+        if (fd_ < 0) throw ads::ds::rbt::exception::TreeJournalException();
+    }
+
+    template <typename T>
+    inline JournaledRBTree<T>::~JournaledRBTree() {
+        try {
+            Commit();
+        }
+        catch (...) {}
+
+        ::close(fd_);
+    }
+
+    template <typename T>
+    inline void JournaledRBTree<T>::Write_key(std::ostream& out, key_ref_t x) {
+        if constexpr (ads::ds::rbt::serialization::raw_serializable<T>) out.write(reinterpret_cast<const char*>(&x), sizeof(T));
+        else ads::ds::rbt::serialization::Serializer<T>::write(out, x);
+    }
+
+    template <typename T>
+    inline bool JournaledRBTree<T>::Read_key(std::istream& in, T& x) {
+        if constexpr (ads::ds::rbt::serialization::raw_serializable<T>) return static_cast<bool>(in.read(reinterpret_cast<char*>(&x), sizeof(T)));
+        else {
+            try {
+                x = ads::ds::rbt::serialization::Serializer<T>::read(in);
+            }
+            catch (const ads::ds::rbt::exception::TreeSnapshotException&) {
+                return false;
+            }
+
+            return true;
+        }
+    }
+
+    template <typename T>
+    inline bool JournaledRBTree<T>::Apply(const Record& r) {
+        switch (r.op) {
+        case op_t::insert:
+            return static_cast<bool>(tree_.insert(r.first));
+        case op_t::remove:
+            if (auto* p = tree_.node_find(r.first); p != nullptr) {
+                delete tree_.node_extract(p);
+
+                return true;
+            }
+
+            return false;
+        case op_t::replace:
+            if (auto* p = tree_.node_find(r.first); p != nullptr && tree_.node_find(r.second) == nullptr) {
+                delete tree_.node_extract(p);
+                tree_.insert(r.second);
+
+                return true;
+            }
+
+            return false;
+        }
+
+        return false;
+    }
+
+    template <typename T>
+    inline void JournaledRBTree<T>::Erase(key_ref_t x) {
+        if (auto* p = tree_.node_find(x); p != nullptr) delete tree_.node_extract(p);
+    }
+
+    // Last writer wins: the outcome does not depend on the state the record is replayed over
+    template <typename T>
+    inline void JournaledRBTree<T>::Replay(const Record& r) {
+        switch (r.op) {
+        case op_t::insert:
+            if (tree_.node_find(r.first) == nullptr) tree_.insert(r.first);
+            break;
+        case op_t::remove:
+            Erase(r.first);
+            break;
+        case op_t::replace:
+            Erase(r.first);
+            if (tree_.node_find(r.second) == nullptr) tree_.insert(r.second);
+            break;
+        }
+    }
+
+    template <typename T>
+    inline bool JournaledRBTree<T>::insert(key_ref_t x) {
+        if (!Apply({ op_t::insert, x, x })) return false;
+
+        Log(op_t::insert, x, x);
+
+        return true;
+    }
+
+    template <typename T>
+    inline bool JournaledRBTree<T>::remove(key_ref_t x) {
+        if (!Apply({ op_t::remove, x, x })) return false;
+
+        Log(op_t::remove, x, x);
+
+        return true;
+    }
+
+    // Moves the key from one value to another, fails when from is missing or to is taken
+    template <typename T>
+    inline bool JournaledRBTree<T>::replace(key_ref_t from, key_ref_t to) {
+        if (!Apply({ op_t::replace, from, to })) return false;
+
+        Log(op_t::replace, from, to);
+
+        return true;
+    }
+
+    // Only changes that modified the tree are logged, replaying a record from the tree state it was logged in does what Apply did
+    template <typename T>
+    inline void JournaledRBTree<T>::Log(op_t op, key_ref_t first, key_ref_t second) {
+        buffer_.put(static_cast<char>(op));
+        Write_key(buffer_, first);
+
+        if (op == op_t::replace) Write_key(buffer_, second);
+
+        if (static_cast<std::size_t>(buffer_.tellp()) >= group_bytes) Commit();
+        if (++logged_ >= checkpoint_every_) checkpoint();
+    }
+
+    // Appends the gathered group with one write and makes it durable with one fdatasync
+    template <typename T>
+    inline void JournaledRBTree<T>::Commit() {
+        auto group = buffer_.str();
+
+        if (group.empty()) return;
+
+        for (std::size_t done = 0; done < group.size(); ) {
+            auto written = ::write(fd_, group.data() + done, group.size() - done);
+
+            if (written < 0) throw ads::ds::rbt::exception::TreeJournalException();
+
+            done += static_cast<std::size_t>(written);
+        }
+
+        if (::fdatasync(fd_) != 0) throw ads::ds::rbt::exception::TreeJournalException();
+
+        buffer_.str("");
+    }
+
+    // The snapshot is written aside and renamed over the old one, the journal is emptied only once the rename is durable
+    template <typename T>
+    inline void JournaledRBTree<T>::checkpoint() {
+        auto aside = snapshot_ + ".tmp";
+
+        Commit();
+        tree_.save(aside);
+
+        auto fd = ::open(aside.c_str(), O_RDONLY);
+
+        if (fd < 0 || ::fsync(fd) != 0) {
+            if (fd >= 0) ::close(fd);
+
+            throw ads::ds::rbt::exception::TreeJournalException();
+        }
+
+        ::close(fd);
+
+        if (std::rename(aside.c_str(), snapshot_.c_str()) != 0) throw ads::ds::rbt::exception::TreeJournalException();
+
+        Sync_dir(snapshot_);
+
+        if (::ftruncate(fd_, 0) != 0 || ::fdatasync(fd_) != 0) throw ads::ds::rbt::exception::TreeJournalException();
+
+        logged_ = 0;
+    }
+
+    // fsync on the directory holding file makes a rename of file durable
+    template <typename T>
+    inline void JournaledRBTree<T>::Sync_dir(const std::string& file) {
+        auto dir = std::filesystem::path(file).parent_path();
+        auto fd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_DIRECTORY);
+
+        if (fd < 0) throw ads::ds::rbt::exception::TreeJournalException();
+
+        auto synced = ::fsync(fd) == 0;
+        ::close(fd);
+
+        if (!synced) throw ads::ds::rbt::exception::TreeJournalException();
+    }
+
+    template <typename T>
+    inline void JournaledRBTree<T>::Recover() {
+        if (std::filesystem::exists(snapshot_)) tree_.load(snapshot_);
+        if (!std::filesystem::exists(journal_)) return;
+
+        std::ifstream in(journal_, std::ios::binary);
+        std::vector<Record> batch;
+        std::uintmax_t intact = 0;
+
+        batch.reserve(replay_batch);
+
+        for (;;) {
+            auto op = in.get();
+
+            if (op == std::char_traits<char>::eof()) break;
+
+            Record r{ static_cast<op_t>(op), T{}, T{} };
+
+            if (op < 1 || op > 3 || !Read_key(in, r.first)) break;
+            if (r.op == op_t::replace && !Read_key(in, r.second)) break;
+
+            batch.push_back(std::move(r));
+            logged_++;
+            intact = static_cast<std::uintmax_t>(in.tellg());
+
+            if (batch.size() == replay_batch) {
+                for (auto& b : batch) Replay(b);
+
+                batch.clear();
+            }
+        }
+
+        for (auto& b : batch) Replay(b);
+
+        // Whatever follows the last whole record was cut by a crash
+        if (intact != std::filesystem::file_size(journal_)) std::filesystem::resize_file(journal_, intact);
+    }
+
+}
+
+#endif
@@ -0,0 +1,320 @@
+#ifndef RBTREE_RBT_MAPPED_TREE_HPP
+#define RBTREE_RBT_MAPPED_TREE_HPP
+
+#pragma once
+
+#include "rb_tree.hpp"
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ads::ds::rbt {
+
+    /**
+        * Memory mapped, read only Red-Black Tree
+        * The file holds the nodes of a live tree with array indices instead of RBNode pointers, so it is
+        * searched straight from the mapping (POSIX mmap) and opening it costs one system call, pages fault
+        * in when a search first touches them. Nodes are stored in breadth first order, the top levels of
+        * the tree share a few pages and stay hot.
+        * Layout, integers in the byte order of the writing machine:
+        *   Header                      - magic, version, key and node sizes, number of keys, root index
+        *   Node[size]                  - key, left, right and father indices, npos for none; sons come after
+        *                                 their father, which every walk checks before following a link
+        * Padding bytes are written as zeros.
+    */
+    template <typename T>
+    class MappedRBTree {
+        static_assert(std::is_trivially_copyable_v<T>, "MappedRBTree requires trivially copyable keys");
+
+    public:
+        typedef std::uint64_t index_t;
+
+        struct Node {
+            T       key;
+            index_t left;
+            index_t right;
+            index_t father;
+        };
+
+        struct alignas(64) Header {
+            std::uint32_t magic;
+            std::uint32_t version;
+            std::uint32_t key_bytes;
+            std::uint32_t node_bytes;
+            std::uint64_t size;
+            index_t       root;
+        };
+
+        class const_iterator;
+
+        typedef T                key_t;
+        typedef const T&         key_ref_t;
+        typedef MappedRBTree<T>  self_type;
+        typedef const_iterator   iterator;
+
+        static constexpr index_t       npos    = ~index_t{ 0 };
+        static constexpr std::uint32_t magic   = 0x4d544252;
+        static constexpr std::uint32_t version = 1;
+
+        explicit MappedRBTree(const std::string& path);
+        MappedRBTree(const MappedRBTree&)            = delete;
+        MappedRBTree(MappedRBTree&& s) noexcept      : map_{ std::exchange(s.map_, nullptr) }, bytes_{ std::exchange(s.bytes_, 0) } {};
+        MappedRBTree& operator=(const MappedRBTree&) = delete;
+        ~MappedRBTree()                                                                 { if (map_ != nullptr) ::munmap(map_, bytes_); };
+
+        template <typename Aug, typename Stats, typename Balance>
+        static void write(const ads::ds::rbt::RBTree<T, Aug, Stats, Balance>& tree, const std::string& path);
+
+        std::size_t        size()    const noexcept { return (map_ == nullptr ? 0 : static_cast<std::size_t>(Head().size)); };
+        [[nodiscard]] bool isEmpty() const noexcept { return size() == 0; };
+        bool               find(key_ref_t) const;
+        const_iterator     lower_bound(key_ref_t) const;
+        const_iterator     upper_bound(key_ref_t) const;
+        const_iterator     begin() const;
+        const_iterator     end()   const            { return const_iterator(Nodes(), size(), npos); };
+        const_iterator     cbegin() const           { return begin(); };
+        const_iterator     cend()   const           { return end(); };
+
+    private:
+        // A moved-from tree has no mapping, it reads as empty
+        const Header& Head()  const { return *static_cast<const Header*>(map_); };
+        const Node*   Nodes() const { return (map_ == nullptr ? nullptr : reinterpret_cast<const Node*>(static_cast<const char*>(map_) + sizeof(Header))); };
+        index_t       Root()  const { return (isEmpty() ? npos : Head().root); };
+
+        static index_t Down(std::uint64_t, index_t, index_t);
+        static index_t Up(index_t, index_t);
+
+        void*       map_;
+        std::size_t bytes_;
+    };
+
+    // Walks the nodes in key order through the stored father links, like Iterator does on a live tree
+    template <typename T>
+    class MappedRBTree<T>::const_iterator {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef T                         value_type;
+        typedef std::ptrdiff_t            difference_type;
+        typedef const T*                  pointer;
+        typedef const T&                  reference;
+
+        const_iterator()                                        : nodes_{ nullptr }, size_{ 0 }, at_{ npos } {};
+        const_iterator(const Node* nodes, std::uint64_t size, index_t at) : nodes_{ nodes }, size_{ size }, at_{ at } {};
+
+        reference       operator*()  const                      { return nodes_[at_].key; };
+        pointer         operator->() const                      { return &nodes_[at_].key; };
+        const_iterator& operator++()                            { at_ = Successor(); return *this; };
+        const_iterator  operator++(int)                         { auto old = *this; ++(*this); return old; };
+        bool            operator==(const const_iterator& s) const { return at_ == s.at_; };
+        bool            operator!=(const const_iterator& s) const { return at_ != s.at_; };
+        explicit        operator bool() const                   { return at_ != npos; };
+
+    private:
+        index_t Successor() const {
+            auto p = at_;
+
+            if (nodes_[p].right != npos) {
+                p = Down(size_, p, nodes_[p].right);
+
+                while (nodes_[p].left != npos) p = Down(size_, p, nodes_[p].left);
+
+                return p;
+            }
+
+            auto f = Up(p, nodes_[p].father);
+
+            while (f != npos && nodes_[f].right == p) {
+                p = f;
+                f = Up(f, nodes_[f].father);
+            }
+
+            return f;
+        };
+
+        const Node*   nodes_;
+        std::uint64_t size_;
+        index_t       at_;
+    };
+
+    template <typename T>
+    inline MappedRBTree<T>::MappedRBTree(const std::string& path) : map_{ nullptr }, bytes_{ 0 } {
+        auto fd = ::open(path.c_str(), O_RDONLY);
+
+        if (fd < 0) throw ads::ds::rbt::exception::TreeMappingException();
+
+        struct stat info {};
+
+        if (::fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < sizeof(Header)) {
+            ::close(fd);
+
+            throw ads::ds::rbt::exception::TreeMappingException();
+        }
+
+        bytes_ = static_cast<std::size_t>(info.st_size);
+        auto* map = ::mmap(nullptr, bytes_, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+
+        if (map == MAP_FAILED) throw ads::ds::rbt::exception::TreeMappingException();
+
+        map_ = map;
+
+        // Searches jump across the file, read ahead would only pull in pages nobody asked for
+        ::madvise(map_, bytes_, MADV_RANDOM);
+
+        const auto& head = Head();
+
+        if (head.magic != magic || head.version != version || head.key_bytes != sizeof(T) || head.node_bytes != sizeof(Node)
+            || head.size > (bytes_ - sizeof(Header)) / sizeof(Node) || (head.size != 0 && head.root >= head.size)) {
+            ::munmap(map_, bytes_);
+            map_ = nullptr;
+
+            throw ads::ds::rbt::exception::TreeMappingException();
+        }
+    }
+
+    // A son index read from the file, npos or past its father and inside the array. Walks only follow checked
+    // links, so a damaged file throws instead of reading out of the mapping or going round in circles
+    template <typename T>
+    inline typename MappedRBTree<T>::index_t MappedRBTree<T>::Down(std::uint64_t size, index_t p, index_t son) {
+        if (son != npos && (son <= p || son >= size)) throw ads::ds::rbt::exception::TreeMappingException();
+
+        return son;
+    }
+
+    // A father index read from the file, npos or before its son
+    template <typename T>
+    inline typename MappedRBTree<T>::index_t MappedRBTree<T>::Up(index_t p, index_t father) {
+        if (father != npos && father >= p) throw ads::ds::rbt::exception::TreeMappingException();
+
+        return father;
+    }
+
+    // Numbers the nodes in breadth first order, the sons of a node get their indices when it is written
+    template <typename T>
+    template <typename Aug, typename Stats, typename Balance>
+    inline void MappedRBTree<T>::write(const ads::ds::rbt::RBTree<T, Aug, Stats, Balance>& tree, const std::string& path) {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+
+        if (!out) throw ads::ds::rbt::exception::TreeMappingException();
+
+        std::deque<std::pair<typename ads::ds::rbt::RBTree<T, Aug, Stats, Balance>::node_ptr_t, index_t>> queue;
+        index_t next = 0;
+        Header header;
+
+        // Padding included, no stale bytes of the process end up in the file
+        std::memset(static_cast<void*>(&header), 0, sizeof(header));
+        header.magic = magic;
+        header.version = version;
+        header.key_bytes = sizeof(T);
+        header.node_bytes = sizeof(Node);
+        header.root = (tree.getRoot() == nullptr ? npos : 0);
+
+        // Counted while writing, the header is rewritten at the end
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        if (tree.getRoot() != nullptr) {
+            queue.emplace_back(tree.getRoot(), npos);
+            next = 1;
+        }
+
+        for (index_t at = 0; !queue.empty(); ++at) {
+            auto [p, father] = queue.front();
+            queue.pop_front();
+
+            Node node;
+
+            std::memset(static_cast<void*>(&node), 0, sizeof(node));
+            node.key = p->key;
+            node.left = npos;
+            node.right = npos;
+            node.father = father;
+
+            if (p->left != nullptr) {
+                node.left = next++;
+                queue.emplace_back(p->left, at);
+            }
+            if (p->right != nullptr) {
+                node.right = next++;
+                queue.emplace_back(p->right, at);
+            }
+
+            out.write(reinterpret_cast<const char*>(&node), sizeof(node));
+            header.size++;
+        }
+
+        out.seekp(0);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        if (!out.flush()) throw ads::ds::rbt::exception::TreeMappingException();
+    }
+
+    template <typename T>
+    inline bool MappedRBTree<T>::find(key_ref_t x) const {
+        const auto* nodes = Nodes();
+        auto p = Root();
+
+        while (p != npos) {
+            if (x == nodes[p].key) return true;
+
+            p = Down(size(), p, x < nodes[p].key ? nodes[p].left : nodes[p].right);
+        }
+
+        return false;
+    }
+
+    template <typename T>
+    inline typename MappedRBTree<T>::const_iterator MappedRBTree<T>::lower_bound(key_ref_t x) const {
+        const auto* nodes = Nodes();
+        auto p = Root();
+        auto best = npos;
+
+        while (p != npos) {
+            if (nodes[p].key < x) p = Down(size(), p, nodes[p].right);
+            else {
+                best = p;
+                p = Down(size(), p, nodes[p].left);
+            }
+        }
+
+        return const_iterator(nodes, size(), best);
+    }
+
+    template <typename T>
+    inline typename MappedRBTree<T>::const_iterator MappedRBTree<T>::upper_bound(key_ref_t x) const {
+        const auto* nodes = Nodes();
+        auto p = Root();
+        auto best = npos;
+
+        while (p != npos) {
+            if (x < nodes[p].key) {
+                best = p;
+                p = Down(size(), p, nodes[p].left);
+            }
+            else p = Down(size(), p, nodes[p].right);
+        }
+
+        return const_iterator(nodes, size(), best);
+    }
+
+    template <typename T>
+    inline typename MappedRBTree<T>::const_iterator MappedRBTree<T>::begin() const {
+        const auto* nodes = Nodes();
+        auto p = Root();
+
+        while (p != npos && nodes[p].left != npos) p = Down(size(), p, nodes[p].left);
+
+        return const_iterator(nodes, size(), p);
+    }
+
+}
+
+#endif
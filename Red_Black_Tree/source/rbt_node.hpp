@@ -7,33 +7,39 @@
 #include <iterator>
 #include <utility>
 #include "exceptions.hpp"
+#include "rbt_augment.hpp"
+#include "rbt_stats.hpp"
 
 namespace ads::ds::rbt::node_impl {
 
     enum colors { red, black };
 
-    template <typename T>
+    template <typename T, typename Aug = ads::ds::rbt::augment::NoAugmentation>
     class RBNode {
     public:
         typedef T           key_t;
         typedef T&          key_ref_t;
-        typedef RBNode<T>   node_t;
-        typedef RBNode<T>*  node_ptr_t;
-        typedef RBNode<T>&  node_ref_t;
-        typedef RBNode<T>&& node_rval_t;
-
-        key_t      key;
-        node_ptr_t father;
-        node_ptr_t left;
-        node_ptr_t right;
-        int        color;
-
-        RBNode()                                               : father{ nullptr }, left{ nullptr }, right{ nullptr }, color{ black } {};
-        explicit RBNode(key_t input)                           : key{ input }, father{ nullptr }, left{ nullptr }, right{ nullptr }, color{ red } {};
-        RBNode(const node_ref_t s)                             : key{ s.key }, father{ s.father }, left{ s.left }, right{ s.right }, color{ s.color } {};
-        RBNode(node_rval_t s) noexcept                         : key{ s.key }, father{ s.father }, left{ s.left }, right{ s.right }, color{ s.color } {};
-        RBNode(key_t input, node_ptr_t father_)                : key{ input }, father{ father_ }, left{ nullptr }, right{ nullptr }, color{ red } {};
-        RBNode(key_t input, node_ptr_t father_, int new_color) : key{ input }, father{ father_ }, left{ nullptr }, right{ nullptr }, color{ new_color } {};
+        typedef RBNode<T, Aug>   node_t;
+        typedef RBNode<T, Aug>*  node_ptr_t;
+        typedef RBNode<T, Aug>&  node_ref_t;
+        typedef RBNode<T, Aug>&& node_rval_t;
+        typedef Aug                           augment_t;
+        typedef typename Aug::value_type      aug_t;
+
+        key_t                        key;
+        node_ptr_t                   father;
+        node_ptr_t                   left;
+        node_ptr_t                   right;
+        int                          color;
+        // Aggregate of the subtree rooted here, takes no space without augmentation
+        [[no_unique_address]] aug_t  aug;
+
+        RBNode()                                               : father{ nullptr }, left{ nullptr }, right{ nullptr }, color{ black }, aug{ Aug::identity() } {};
+        explicit RBNode(key_t input)                           : key{ input }, father{ nullptr }, left{ nullptr }, right{ nullptr }, color{ red }, aug{ Aug::lift(key) } {};
+        RBNode(const node_ref_t s)                             : key{ s.key }, father{ s.father }, left{ s.left }, right{ s.right }, color{ s.color }, aug{ s.aug } {};
+        RBNode(node_rval_t s) noexcept                         : key{ s.key }, father{ s.father }, left{ s.left }, right{ s.right }, color{ s.color }, aug{ s.aug } {};
+        RBNode(key_t input, node_ptr_t father_)                : key{ input }, father{ father_ }, left{ nullptr }, right{ nullptr }, color{ red }, aug{ Aug::lift(key) } {};
+        RBNode(key_t input, node_ptr_t father_, int new_color) : key{ input }, father{ father_ }, left{ nullptr }, right{ nullptr }, color{ new_color }, aug{ Aug::lift(key) } {};
         ~RBNode() = default;
 
         node_ref_t operator= (const key_ref_t input)         { key = input; return *this; };
@@ -84,18 +90,18 @@ namespace ads::ds::rbt::node_impl {
         [[nodiscard]] bool is_right_son() const { return ((father != nullptr) && father->right == this); };
         node_ptr_t         max_node()           { return ((right == nullptr) ? this : right->max_node()); };
         node_ptr_t         min_node()           { return ((left == nullptr) ? this : left->min_node()); };
-        node_ptr_t         node_Successor();
-        node_ptr_t         node_Predecessor();
+        node_ptr_t         node_Successor(std::size_t* climbs = nullptr);
+        node_ptr_t         node_Predecessor(std::size_t* climbs = nullptr);
         node_ptr_t         node_Sibling();
     };
 
-    template<typename T>
-    typename RBNode<T>::node_ref_t RBNode<T>::operator=(const node_ref_t input) {
+    template<typename T, typename Aug>
+    typename RBNode<T, Aug>::node_ref_t RBNode<T, Aug>::operator=(const node_ref_t input) {
         if (this == &input) return *this;
 
-        auto* newFather = RBNode<T>();
-        auto* newLeft = RBNode<T>();
-        auto* newRight = RBNode<T>();
+        auto* newFather = RBNode<T, Aug>();
+        auto* newLeft = RBNode<T, Aug>();
+        auto* newRight = RBNode<T, Aug>();
 
         try {
             newFather = new RBNode(*input.father);
@@ -122,11 +128,11 @@ namespace ads::ds::rbt::node_impl {
         return *this;
     }
 
-    template<typename T>
-    typename RBNode<T>::node_ref_t RBNode<T>::operator=(node_rval_t input) noexcept {
-        auto* newFather = RBNode<T>();
-        auto* newLeft = RBNode<T>();
-        auto* newRight = RBNode<T>();
+    template<typename T, typename Aug>
+    typename RBNode<T, Aug>::node_ref_t RBNode<T, Aug>::operator=(node_rval_t input) noexcept {
+        auto* newFather = RBNode<T, Aug>();
+        auto* newLeft = RBNode<T, Aug>();
+        auto* newRight = RBNode<T, Aug>();
 
         try {
             newFather = new RBNode(*input.father);
@@ -153,8 +159,8 @@ namespace ads::ds::rbt::node_impl {
         return *this;
     }
 
-    template <typename T>
-    inline typename RBNode<T>::key_t RBNode<T>::operator[](const size_t& id) {
+    template <typename T, typename Aug>
+    inline typename RBNode<T, Aug>::key_t RBNode<T, Aug>::operator[](const size_t& id) {
         if (id < 0 || id > 3) throw ads::ds::rbt::exception::NodeIndexOutOfBoundException();
         else if (id == 0) return this->key;
         else if (id == 1) return father->key;
@@ -162,8 +168,8 @@ namespace ads::ds::rbt::node_impl {
         else return right->key;
     }
 
-    template <typename T>
-    inline typename RBNode<T>::key_t RBNode<T>::operator[](const size_t& id) const {
+    template <typename T, typename Aug>
+    inline typename RBNode<T, Aug>::key_t RBNode<T, Aug>::operator[](const size_t& id) const {
         if (id < 0 || id > 3) throw ads::ds::rbt::exception::NodeIndexOutOfBoundException();
         else if (id == 0) return this->key;
         else if (id == 1) return father->key;
@@ -171,8 +177,8 @@ namespace ads::ds::rbt::node_impl {
         else return right->key;
     }
 
-    template <typename T>
-    inline void RBNode<T>::print_node() {
+    template <typename T, typename Aug>
+    inline void RBNode<T, Aug>::print_node() {
         std::cout << "Key: " << key << ", color: " << (color == black ? "B" : "R") << std::endl;
 
         if (father != nullptr) std::cout << "(Father) key: " << father->key << ", color: " << (father->color == black ? "B" : "R") << std::endl;
@@ -188,51 +194,93 @@ namespace ads::ds::rbt::node_impl {
     }
 
     // For in-oredr walk / increment in iterator
-    template <typename T>
-    inline typename RBNode<T>::node_ptr_t RBNode<T>::node_Successor() {
+    // climbs, when given, is increased by the number of father links followed
+    template <typename T, typename Aug>
+    inline typename RBNode<T, Aug>::node_ptr_t RBNode<T, Aug>::node_Successor(std::size_t* climbs) {
         if (this != nullptr) {
             if (right != nullptr) return right->min_node();
-            else if (is_left_son()) return father;
+            else if (is_left_son()) {
+                if (climbs != nullptr) ++*climbs;
+
+                return father;
+            }
 
             auto successor = this;
 
             do {
                 successor = successor->father;
+
+                if (climbs != nullptr) ++*climbs;
             } while ((successor != nullptr) && (successor->is_right_son()));
 
-            if (successor != nullptr) return successor->father;
-            else return nullptr;
+            if (successor == nullptr) return nullptr;
+            if (climbs != nullptr) ++*climbs;
+
+            return successor->father;
         }
 
         return nullptr;
     }
 
     // For reverse in-oredr walk / decrement in iterator
-    template <typename T>
-    inline typename RBNode<T>::node_ptr_t RBNode<T>::node_Predecessor() {
+    template <typename T, typename Aug>
+    inline typename RBNode<T, Aug>::node_ptr_t RBNode<T, Aug>::node_Predecessor(std::size_t* climbs) {
         if (this != nullptr) {
             if (left != nullptr) return left->max_node();
-            else if (is_right_son()) return father;
+            else if (is_right_son()) {
+                if (climbs != nullptr) ++*climbs;
+
+                return father;
+            }
 
             auto predeccesor = this;
 
             do {
                 predeccesor = predeccesor->father;
+
+                if (climbs != nullptr) ++*climbs;
             } while ((predeccesor != nullptr) && (predeccesor->is_left_son()));
 
-            if (predeccesor != nullptr) return predeccesor->father;
-            else return nullptr;
+            if (predeccesor == nullptr) return nullptr;
+            if (climbs != nullptr) ++*climbs;
+
+            return predeccesor->father;
         }
 
         return nullptr;
     }
 
-    template <typename T>
-    inline typename RBNode<T>::node_ptr_t RBNode<T>::node_Sibling() {
+    template <typename T, typename Aug>
+    inline typename RBNode<T, Aug>::node_ptr_t RBNode<T, Aug>::node_Sibling() {
         if (this != nullptr) return (father == nullptr ? nullptr : (is_left_son() ? father->right : father->left));
         else return nullptr;
     }
 
+    // Iterator steps, the father links climbed are reported to the Stats policy of the tree
+    template <typename Stats, typename Node>
+    inline Node* successor_of(Node* n) {
+        if constexpr (Stats::enabled) {
+            std::size_t climbs = 0;
+            auto* next = n->node_Successor(&climbs);
+            Stats::count(ads::ds::rbt::stats::successor_climb, climbs);
+
+            return next;
+        }
+        else return n->node_Successor();
+    }
+
+    template <typename Stats, typename Node>
+    inline Node* predecessor_of(Node* n) {
+        if constexpr (Stats::enabled) {
+            std::size_t climbs = 0;
+            auto* next = n->node_Predecessor(&climbs);
+            Stats::count(ads::ds::rbt::stats::successor_climb, climbs);
+
+            return next;
+        }
+        else return n->node_Predecessor();
+    }
+
 }
 
 #endif
@@ -0,0 +1,338 @@
+#ifndef RBTREE_RBT_PARALLEL_HPP
+#define RBTREE_RBT_PARALLEL_HPP
+
+#pragma once
+
+#include "rb_tree.hpp"
+#include <atomic>
+#include <bit>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace ads::ds::rbt::parallel {
+
+    /**
+        * Work stealing pool
+        * Every worker owns a deque, pushes and pops its own tasks at the back and steals from the front
+        * of the others when idle. A thread waiting for a TaskGroup keeps executing tasks, so nested
+        * fork-join over subtrees never blocks a worker.
+    */
+    class WorkStealingPool {
+    public:
+        typedef std::function<void()> task_t;
+
+        class TaskGroup;
+
+        explicit WorkStealingPool(std::size_t workers = std::thread::hardware_concurrency());
+        WorkStealingPool(const WorkStealingPool&)            = delete;
+        WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+        ~WorkStealingPool();
+
+        std::size_t workers() const { return queues_.size(); };
+        void        submit(task_t);
+        bool        run_one();
+
+    private:
+        struct alignas(64) Queue {
+            std::mutex         lock;
+            std::deque<task_t> tasks;
+        };
+
+        void Work(std::size_t);
+        bool Pop(std::size_t, task_t&);
+        bool Steal(std::size_t, task_t&);
+
+        static inline thread_local const WorkStealingPool* current_pool_ = nullptr;
+        static inline thread_local std::size_t              current_id_   = 0;
+
+        std::vector<std::unique_ptr<Queue>> queues_;
+        std::vector<std::thread>            threads_;
+        std::atomic<std::size_t>            pending_;
+        std::atomic<std::size_t>            next_;
+        std::atomic<bool>                   stop_;
+        std::mutex                          sleep_lock_;
+        std::condition_variable             sleep_;
+    };
+
+    // Counts outstanding tasks, wait() helps the pool until all of them finished. The first exception thrown
+    // by a task is kept and rethrown by wait(), the destructor only waits
+    class WorkStealingPool::TaskGroup {
+    public:
+        explicit TaskGroup(WorkStealingPool& pool) : pool_{ pool }, left_{ 0 } {};
+        TaskGroup(const TaskGroup&)            = delete;
+        TaskGroup& operator=(const TaskGroup&) = delete;
+        ~TaskGroup()                                                          { Drain(); };
+
+        void run(task_t task) {
+            left_.fetch_add(1, std::memory_order_relaxed);
+            pool_.submit([this, task = std::move(task)] {
+                // Counts the task done however it ends, a throwing task must not leave wait() spinning
+                struct Done {
+                    std::atomic<std::size_t>& left;
+                    ~Done() { left.fetch_sub(1, std::memory_order_release); };
+                } done{ left_ };
+
+                try {
+                    task();
+                }
+                catch (...) {
+                    std::lock_guard<std::mutex> lock(error_lock_);
+
+                    if (!error_) error_ = std::current_exception();
+                }
+            });
+        };
+
+        void wait() {
+            Drain();
+
+            std::exception_ptr error;
+
+            {
+                std::lock_guard<std::mutex> lock(error_lock_);
+                std::swap(error, error_);
+            }
+
+            if (error) std::rethrow_exception(error);
+        };
+
+    private:
+        void Drain() {
+            while (left_.load(std::memory_order_acquire) != 0) {
+                if (!pool_.run_one()) std::this_thread::yield();
+            }
+        };
+
+        WorkStealingPool&        pool_;
+        std::atomic<std::size_t> left_;
+        std::mutex               error_lock_;
+        std::exception_ptr       error_;
+    };
+
+    inline WorkStealingPool::WorkStealingPool(std::size_t workers) : pending_{ 0 }, next_{ 0 }, stop_{ false } {
+        workers = (workers == 0 ? 1 : workers);
+
+        for (std::size_t i = 0; i < workers; ++i) {
+            queues_.push_back(std::make_unique<Queue>());
+        }
+        for (std::size_t i = 0; i < workers; ++i) {
+            threads_.emplace_back([this, i] { Work(i); });
+        }
+    }
+
+    inline WorkStealingPool::~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_lock_);
+            stop_ = true;
+        }
+
+        sleep_.notify_all();
+
+        for (auto& t : threads_) t.join();
+    }
+
+    inline void WorkStealingPool::submit(task_t task) {
+        // Workers keep their own tasks local, outside threads spread them round robin
+        auto id = (current_pool_ == this ? current_id_ : next_.fetch_add(1, std::memory_order_relaxed) % queues_.size());
+
+        pending_.fetch_add(1, std::memory_order_release);
+
+        {
+            std::lock_guard<std::mutex> lock(queues_[id]->lock);
+            queues_[id]->tasks.push_back(std::move(task));
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(sleep_lock_);
+        }
+
+        sleep_.notify_one();
+    }
+
+    inline bool WorkStealingPool::Pop(std::size_t id, task_t& task) {
+        std::lock_guard<std::mutex> lock(queues_[id]->lock);
+
+        if (queues_[id]->tasks.empty()) return false;
+
+        task = std::move(queues_[id]->tasks.back());
+        queues_[id]->tasks.pop_back();
+
+        return true;
+    }
+
+    inline bool WorkStealingPool::Steal(std::size_t id, task_t& task) {
+        for (std::size_t i = 1; i <= queues_.size(); ++i) {
+            auto& victim = *queues_[(id + i) % queues_.size()];
+            std::lock_guard<std::mutex> lock(victim.lock);
+
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // Runs one queued task on the calling thread, used by waiting threads to help instead of blocking
+    inline bool WorkStealingPool::run_one() {
+        task_t task;
+        auto id = (current_pool_ == this ? current_id_ : 0);
+
+        if ((current_pool_ == this && Pop(id, task)) || Steal(id, task)) {
+            pending_.fetch_sub(1, std::memory_order_relaxed);
+            task();
+
+            return true;
+        }
+
+        return false;
+    }
+
+    inline void WorkStealingPool::Work(std::size_t id) {
+        current_pool_ = this;
+        current_id_ = id;
+
+        while (!stop_.load(std::memory_order_acquire)) {
+            if (run_one()) continue;
+
+            std::unique_lock<std::mutex> lock(sleep_lock_);
+            sleep_.wait(lock, [this] { return stop_.load() || pending_.load(std::memory_order_acquire) != 0; });
+        }
+    }
+
+    inline WorkStealingPool& default_pool() {
+        static WorkStealingPool pool;
+
+        return pool;
+    }
+
+    namespace detail {
+
+        // Subtrees below this depth are walked sequentially, a few tasks per worker are enough to balance
+        inline std::size_t spawn_depth(const WorkStealingPool& pool) {
+            return static_cast<std::size_t>(std::bit_width(pool.workers())) + 3;
+        }
+
+        // Bounds are [lo, hi), a null bound is open; sons only inherit the bound they can still cross
+        template <typename Node, typename F>
+        void walk(Node* n, const typename Node::key_t* lo, const typename Node::key_t* hi, F& f) {
+            while (n != nullptr) {
+                if (lo != nullptr && n->key < *lo) {
+                    n = n->right;
+                    continue;
+                }
+                if (hi != nullptr && !(n->key < *hi)) {
+                    n = n->left;
+                    continue;
+                }
+
+                walk(n->left, lo, static_cast<const typename Node::key_t*>(nullptr), f);
+                f(n->key);
+                n = n->right;
+                lo = nullptr;
+            }
+        }
+
+        template <typename Node, typename F>
+        void for_each(WorkStealingPool& pool, Node* n, const typename Node::key_t* lo, const typename Node::key_t* hi, F& f, std::size_t depth) {
+            while (n != nullptr && ((lo != nullptr && n->key < *lo) || (hi != nullptr && !(n->key < *hi)))) {
+                n = ((lo != nullptr && n->key < *lo) ? n->right : n->left);
+            }
+
+            if (n == nullptr) return;
+            if (depth >= spawn_depth(pool)) {
+                walk(n, lo, hi, f);
+
+                return;
+            }
+
+            WorkStealingPool::TaskGroup group(pool);
+            group.run([&pool, n, lo, &f, depth] { for_each(pool, n->left, lo, static_cast<const typename Node::key_t*>(nullptr), f, depth + 1); });
+            f(n->key);
+            for_each(pool, n->right, static_cast<const typename Node::key_t*>(nullptr), hi, f, depth + 1);
+            group.wait();
+        }
+
+        // Empty optional stands for the reduction of no keys, so op never needs an identity element
+        template <typename R, typename Node, typename Op, typename Map>
+        std::optional<R> reduce(WorkStealingPool& pool, Node* n, const typename Node::key_t* lo, const typename Node::key_t* hi, Op& op, Map& map, std::size_t depth) {
+            while (n != nullptr && ((lo != nullptr && n->key < *lo) || (hi != nullptr && !(n->key < *hi)))) {
+                n = ((lo != nullptr && n->key < *lo) ? n->right : n->left);
+            }
+
+            if (n == nullptr) return std::nullopt;
+
+            std::optional<R> left;
+            std::optional<R> right;
+            const typename Node::key_t* none = nullptr;
+
+            if (depth >= spawn_depth(pool)) {
+                left = reduce<R>(pool, n->left, lo, none, op, map, depth);
+                right = reduce<R>(pool, n->right, none, hi, op, map, depth);
+            }
+            else {
+                WorkStealingPool::TaskGroup group(pool);
+                group.run([&] { left = reduce<R>(pool, n->left, lo, none, op, map, depth + 1); });
+                right = reduce<R>(pool, n->right, none, hi, op, map, depth + 1);
+                group.wait();
+            }
+
+            // In-order combination: left subtree, node, right subtree
+            R middle = (left ? op(std::move(*left), map(n->key)) : R(map(n->key)));
+
+            return (right ? op(std::move(middle), std::move(*right)) : middle);
+        }
+
+    }
+
+    /**
+        * Parallel algorithms over a tree or an iterator range [first, last) of it
+        * Work is split at subtree boundaries, f may run concurrently for different keys. Reductions combine
+        * partial results strictly in key order, so op only has to be associative, not commutative.
+    */
+    template <typename T, typename Aug, typename Stats, typename Balance, typename F>
+    void parallel_for_each(ads::ds::rbt::RBTree<T, Aug, Stats, Balance>& tree, F f, WorkStealingPool& pool = default_pool()) {
+        detail::for_each(pool, tree.getRoot(), static_cast<const T*>(nullptr), static_cast<const T*>(nullptr), f, 0);
+    }
+
+    template <typename T, typename Aug, typename Stats, typename Balance, typename F>
+    void parallel_for_each(ads::ds::rbt::RBTree<T, Aug, Stats, Balance>& tree, typename ads::ds::rbt::RBTree<T, Aug, Stats, Balance>::iterator first, typename ads::ds::rbt::RBTree<T, Aug, Stats, Balance>::iterator last, F f, WorkStealingPool& pool = default_pool()) {
+        if (first == last) return;
+
+        detail::for_each(pool, tree.getRoot(), &*first, (last ? &*last : static_cast<const T*>(nullptr)), f, 0);
+    }
+
+    template <typename T, typename Aug, typename Stats, typename Balance, typename R, typename Op, typename Map>
+    R parallel_transform_reduce(ads::ds::rbt::RBTree<T, Aug, Stats, Balance>& tree, typename ads::ds::rbt::RBTree<T, Aug, Stats, Balance>::iterator first, typename ads::ds::rbt::RBTree<T, Aug, Stats, Balance>::iterator last, R init, Op op, Map map, WorkStealingPool& pool = default_pool()) {
+        if (first == last) return init;
+
+        auto total = detail::reduce<R>(pool, tree.getRoot(), &*first, (last ? &*last : static_cast<const T*>(nullptr)), op, map, 0);
+
+        return (total ? op(std::move(init), std::move(*total)) : init);
+    }
+
+    template <typename T, typename Aug, typename Stats, typename Balance, typename R, typename Op>
+    R parallel_reduce(ads::ds::rbt::RBTree<T, Aug, Stats, Balance>& tree, typename ads::ds::rbt::RBTree<T, Aug, Stats, Balance>::iterator first, typename ads::ds::rbt::RBTree<T, Aug, Stats, Balance>::iterator last, R init, Op op, WorkStealingPool& pool = default_pool()) {
+        auto identity = [](const T& x) -> R { return R(x); };
+
+        return parallel_transform_reduce(tree, first, last, std::move(init), op, identity, pool);
+    }
+
+    template <typename T, typename Aug, typename Stats, typename Balance, typename R, typename Op>
+    R parallel_reduce(ads::ds::rbt::RBTree<T, Aug, Stats, Balance>& tree, R init, Op op, WorkStealingPool& pool = default_pool()) {
+        return parallel_reduce(tree, tree.begin(), tree.end(), std::move(init), op, pool);
+    }
+
+}
+
+#endif
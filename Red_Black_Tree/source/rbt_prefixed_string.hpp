@@ -0,0 +1,90 @@
+#ifndef RBTREE_RBT_PREFIXED_STRING_HPP
+#define RBTREE_RBT_PREFIXED_STRING_HPP
+
+#pragma once
+
+#include "rbt_serializer.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace ads::ds::rbt {
+
+    /**
+        * String key with its first 8 bytes kept inline
+        * The leading bytes are packed big-endian into one integer (zero padded), so comparing the integers
+        * orders the keys the way comparing the bytes does. A search compares the integers first and reads
+        * the heap buffer of the string only when they tie, then from the 9th byte on.
+        * Use as RBTree<PrefixedString>; keys sharing a long common start (one scheme, one root directory)
+        * tie on every level and gain nothing.
+    */
+    class PrefixedString {
+    public:
+        static constexpr std::size_t prefix_bytes = sizeof(std::uint64_t);
+
+        PrefixedString() = default;
+        PrefixedString(std::string s) : prefix_(Pack(s)), text_(std::move(s)) {};
+        PrefixedString(std::string_view s) : PrefixedString(std::string(s)) {};
+        PrefixedString(const char* s) : PrefixedString(std::string(s)) {};
+
+        const std::string& str()    const { return text_; };
+        std::uint64_t      prefix() const { return prefix_; };
+        std::size_t        size()   const { return text_.size(); };
+
+        // Negative, zero or positive like std::string::compare
+        int compare(const PrefixedString& s) const {
+            if (prefix_ != s.prefix_) return (prefix_ < s.prefix_ ? -1 : 1);
+            if (text_.size() < prefix_bytes || s.text_.size() < prefix_bytes) return text_.compare(s.text_);
+
+            return text_.compare(prefix_bytes, std::string::npos, s.text_, prefix_bytes, std::string::npos);
+        };
+
+        bool operator==(const PrefixedString& s) const { return prefix_ == s.prefix_ && text_ == s.text_; };
+        bool operator!=(const PrefixedString& s) const { return !(*this == s); };
+        bool operator< (const PrefixedString& s) const { return compare(s) < 0; };
+        bool operator> (const PrefixedString& s) const { return compare(s) > 0; };
+        bool operator<=(const PrefixedString& s) const { return compare(s) <= 0; };
+        bool operator>=(const PrefixedString& s) const { return compare(s) >= 0; };
+
+        friend std::ostream& operator<<(std::ostream& ofs, const PrefixedString& s) {
+            return ofs << s.text_;
+        };
+
+    private:
+        static std::uint64_t Pack(std::string_view s) {
+            std::uint64_t p = 0;
+
+            for (std::size_t i = 0; i < prefix_bytes; ++i) p = (p << 8) | (i < s.size() ? static_cast<unsigned char>(s[i]) : 0u);
+
+            return p;
+        };
+
+        std::uint64_t prefix_ = 0;
+        std::string   text_;
+    };
+
+}
+
+namespace ads::ds::rbt::serialization {
+
+    // Only the string goes to disk, the prefix is packed again on read
+    template <>
+    struct Serializer<ads::ds::rbt::PrefixedString> {
+        static void write(std::ostream& out, const ads::ds::rbt::PrefixedString& s) { Serializer<std::string>::write(out, s.str()); };
+
+        static ads::ds::rbt::PrefixedString read(std::istream& in) { return { Serializer<std::string>::read(in) }; };
+    };
+
+}
+
+// Same hash as the string, MerkleHash trees of PrefixedString and std::string agree
+template <>
+struct std::hash<ads::ds::rbt::PrefixedString> {
+    std::size_t operator()(const ads::ds::rbt::PrefixedString& s) const noexcept { return std::hash<std::string>{}(s.str()); };
+};
+
+#endif
@@ -0,0 +1,160 @@
+#ifndef RBTREE_RBT_PRIORITY_DEQUE_HPP
+#define RBTREE_RBT_PRIORITY_DEQUE_HPP
+
+#pragma once
+
+#include "rb_tree.hpp"
+#include "rbt_sequenced.hpp"
+#include <cstdint>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+namespace ads::ds::rbt {
+
+    /**
+        * Double ended priority queue
+        * An RBTree holding the smallest and the biggest node at hand, min() and max() read them in O(1).
+        * pop_min()/pop_max() unlink the held node straight away (node_extract), no search for its key, and
+        * its neighbour becomes the new extreme in amortized O(1) steps. replace_min()/replace_max() put the
+        * new value into the popped node and link it again, no allocation.
+        * Equal values are allowed: entries carry a push counter (Sequenced), so equal values leave the
+        * min end in push order and the max end in reverse push order.
+    */
+    template <typename T>
+    class RBPriorityDeque {
+    public:
+        typedef T                                   key_t;
+        typedef const T&                            key_ref_t;
+        typedef ads::ds::rbt::Sequenced<T>          entry_t;
+        typedef ads::ds::rbt::RBTree<entry_t>       tree_t;
+        typedef typename tree_t::node_ptr_t         node_ptr_t;
+
+        RBPriorityDeque()  : min_{ nullptr }, max_{ nullptr }, next_{ 0 } {};
+        RBPriorityDeque(std::initializer_list<T> init) : RBPriorityDeque() { for (auto& e : init) push(e); };
+        RBPriorityDeque(const RBPriorityDeque& s) : next_{ s.next_ } { for (auto& e : s.tree_) tree_.insert(e); Refresh(); };
+        RBPriorityDeque(RBPriorityDeque&& s) noexcept : RBPriorityDeque() { swap(s); };
+        ~RBPriorityDeque() = default;
+
+        RBPriorityDeque& operator=(RBPriorityDeque s) noexcept { swap(s); return *this; };
+
+        std::size_t        size()    const { return tree_.size(); };
+        [[nodiscard]] bool isEmpty() const { return min_ == nullptr; };
+        void               clear()         { tree_.clear(); min_ = nullptr; max_ = nullptr; };
+        const tree_t&      tree()    const { return tree_; };
+        key_ref_t          min()     const { return Held(min_); };
+        key_ref_t          max()     const { return Held(max_); };
+        void               push(key_ref_t);
+        T                  pop_min()       { return Pop(min_, true); };
+        T                  pop_max()       { return Pop(max_, false); };
+        T                  push_pop_min(key_ref_t);
+        T                  push_pop_max(key_ref_t);
+        T                  replace_min(key_ref_t x) { return Replace(min_, x); };
+        T                  replace_max(key_ref_t x) { return Replace(max_, x); };
+        std::vector<T>     pop_min_n(std::size_t);
+        void               swap(RBPriorityDeque& s) noexcept;
+
+    private:
+        static key_ref_t Held(node_ptr_t n) {
+            if (n == nullptr) throw ads::ds::rbt::exception::TreeEmptyException();
+
+            return n->key.key;
+        };
+
+        void Refresh() { min_ = tree_.minIt(); max_ = tree_.maxIt(); };
+        T    Pop(node_ptr_t, bool);
+        T    Replace(node_ptr_t, key_ref_t);
+
+        tree_t        tree_;
+        node_ptr_t    min_;
+        node_ptr_t    max_;
+        std::uint64_t next_;
+    };
+
+    // A later push of an equal value sorts after the held ones, so only a strictly smaller value takes the min
+    template <typename T>
+    inline void RBPriorityDeque<T>::push(key_ref_t x) {
+        auto* n = tree_.insert(entry_t{ x, next_++ }).getIter();
+
+        if (min_ == nullptr) {
+            min_ = n;
+            max_ = n;
+        }
+        else if (x < min_->key.key) min_ = n;
+        else if (!(x < max_->key.key)) max_ = n;
+    }
+
+    // Unlinks the held extreme n, its neighbour takes over before the node leaves the tree
+    template <typename T>
+    inline T RBPriorityDeque<T>::Pop(node_ptr_t n, bool low) {
+        if (n == nullptr) throw ads::ds::rbt::exception::TreeEmptyException();
+
+        auto* next = (low ? ads::ds::rbt::node_impl::successor_of<typename tree_t::stats_t>(n) : ads::ds::rbt::node_impl::predecessor_of<typename tree_t::stats_t>(n));
+
+        if (low) min_ = next;
+        else max_ = next;
+
+        if (next == nullptr) {
+            min_ = nullptr;
+            max_ = nullptr;
+        }
+
+        auto* out = tree_.node_extract(n);
+        auto key = std::move(out->key.key);
+        delete out;
+
+        return key;
+    }
+
+    // Pops n and links it again holding x, the node is reused
+    template <typename T>
+    inline T RBPriorityDeque<T>::Replace(node_ptr_t n, key_ref_t x) {
+        if (n == nullptr) throw ads::ds::rbt::exception::TreeEmptyException();
+
+        auto key = std::move(n->key.key);
+        tree_.node_extract(n);
+        n->key = entry_t{ x, next_++ };
+        tree_.node_link(n);
+        Refresh();
+
+        return key;
+    }
+
+    // Pushes x and pops the min, x alone never enters the tree when it would come right out again
+    template <typename T>
+    inline T RBPriorityDeque<T>::push_pop_min(key_ref_t x) {
+        if (min_ == nullptr || !(min_->key.key < x)) return x;
+
+        return replace_min(x);
+    }
+
+    template <typename T>
+    inline T RBPriorityDeque<T>::push_pop_max(key_ref_t x) {
+        if (max_ == nullptr || !(x < max_->key.key)) return x;
+
+        return replace_max(x);
+    }
+
+    // The k smallest values in order. Every pop unlinks the leftmost node, amortized O(1) rebalancing
+    // and successor steps apiece, so the whole run is O(k) with no search.
+    template <typename T>
+    inline std::vector<T> RBPriorityDeque<T>::pop_min_n(std::size_t k) {
+        std::vector<T> out;
+        out.reserve(k < size() ? k : size());
+
+        while (out.size() < k && min_ != nullptr) out.push_back(Pop(min_, true));
+
+        return out;
+    }
+
+    template <typename T>
+    inline void RBPriorityDeque<T>::swap(RBPriorityDeque& s) noexcept {
+        tree_.swap(s.tree_);
+        std::swap(min_, s.min_);
+        std::swap(max_, s.max_);
+        std::swap(next_, s.next_);
+    }
+
+}
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef RBTREE_RBT_RECLAIMER_HPP
+#define RBTREE_RBT_RECLAIMER_HPP
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace ads::ds::rbt::reclamation {
+
+    /**
+        * Background reclaimer
+        * One worker thread frees what the trees hand over (erase_below/erase_above with background = true)
+        * in the order it was queued. The thread starts with the first job; the destructor, run at process
+        * exit for the shared instance, lets it empty the queue and joins it, so nothing outlives main.
+    */
+    class Reclaimer {
+    public:
+        typedef std::function<void()> job_t;
+
+        Reclaimer()                            : stop_{ false }, busy_{ false } {};
+        Reclaimer(const Reclaimer&)            = delete;
+        Reclaimer& operator=(const Reclaimer&) = delete;
+        ~Reclaimer();
+
+        static Reclaimer& shared()                    { static Reclaimer instance; return instance; };
+
+        void post(job_t);
+        void drain();
+
+    private:
+        void Run();
+
+        std::mutex              lock_;
+        std::condition_variable wake_;
+        std::condition_variable idle_;
+        std::deque<job_t>       jobs_;
+        std::thread             worker_;
+        bool                    stop_;
+        bool                    busy_;
+    };
+
+    inline Reclaimer::~Reclaimer() {
+        {
+            std::lock_guard<std::mutex> lock(lock_);
+            stop_ = true;
+        }
+
+        wake_.notify_one();
+
+        if (worker_.joinable()) worker_.join();
+    }
+
+    inline void Reclaimer::post(job_t job) {
+        {
+            std::lock_guard<std::mutex> lock(lock_);
+            jobs_.push_back(std::move(job));
+
+            if (!worker_.joinable()) worker_ = std::thread([this] { Run(); });
+        }
+
+        wake_.notify_one();
+    }
+
+    // Waits until every job posted so far has run
+    inline void Reclaimer::drain() {
+        std::unique_lock<std::mutex> lock(lock_);
+        idle_.wait(lock, [this] { return jobs_.empty() && !busy_; });
+    }
+
+    // Jobs run outside the lock, a stop request is honoured once the queue is empty
+    inline void Reclaimer::Run() {
+        std::unique_lock<std::mutex> lock(lock_);
+
+        while (true) {
+            wake_.wait(lock, [this] { return stop_ || !jobs_.empty(); });
+
+            if (jobs_.empty()) return;
+
+            auto job = std::move(jobs_.front());
+            jobs_.pop_front();
+            busy_ = true;
+            lock.unlock();
+            job();
+            lock.lock();
+            busy_ = false;
+
+            if (jobs_.empty()) idle_.notify_all();
+        }
+    }
+
+}
+
+#endif
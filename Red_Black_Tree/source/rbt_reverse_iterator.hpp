@@ -7,10 +7,10 @@
 
 namespace ads::ds::rbt::iterators {
 
-    template <typename T>
+    template <typename T, typename Aug = ads::ds::rbt::augment::NoAugmentation, typename Stats = ads::ds::rbt::stats::NoStats>
     class ReverseIterator {
     protected:
-        ads::ds::rbt::node_impl::RBNode<T>* Iter;
+        ads::ds::rbt::node_impl::RBNode<T, Aug>* Iter;
 
     public:
         typedef ReverseIterator           self_type;
@@ -21,11 +21,11 @@ namespace ads::ds::rbt::iterators {
         typedef int                       difference_type;
 
         ReverseIterator()                                                 : Iter{ nullptr } {};
-        explicit ReverseIterator(ads::ds::rbt::node_impl::RBNode<T>* ptr) : Iter{ ptr } {};
+        explicit ReverseIterator(ads::ds::rbt::node_impl::RBNode<T, Aug>* ptr) : Iter{ ptr } {};
         ReverseIterator(const ReverseIterator& s)                         : Iter{ s.Iter } {};
         ReverseIterator(const ReverseIterator&& s) noexcept               : Iter{ s.Iter } {};
 
-        inline ads::ds::rbt::node_impl::RBNode<T>* getIter() { return Iter; };
+        inline ads::ds::rbt::node_impl::RBNode<T, Aug>* getIter() { return Iter; };
 
         ReverseIterator       operator++                                         ();
         const ReverseIterator operator++                                         (int);
@@ -35,43 +35,43 @@ namespace ads::ds::rbt::iterators {
         ReverseIterator&      operator=                                          (ReverseIterator&& source)   noexcept { this->Iter = source.Iter; return (*this); };
         bool                  operator==                                         (const ReverseIterator& source) const { return (Iter == source.Iter); };
         bool                  operator!=                                         (const ReverseIterator& source) const { return (Iter != source.Iter); };
-        explicit              operator ads::ds::rbt::node_impl::RBNode<T>&       ()                                    { return (*Iter); };
-        explicit              operator const ads::ds::rbt::node_impl::RBNode<T>& ()                              const { return (*Iter); };
+        explicit              operator ads::ds::rbt::node_impl::RBNode<T, Aug>&       ()                                    { return (*Iter); };
+        explicit              operator const ads::ds::rbt::node_impl::RBNode<T, Aug>& ()                              const { return (*Iter); };
         T& operator*                                                             ()                              const { return (Iter->key); };
-        ads::ds::rbt::node_impl::RBNode<T>* operator->                           ()                              const { return Iter; };
+        ads::ds::rbt::node_impl::RBNode<T, Aug>* operator->                           ()                              const { return Iter; };
         explicit              operator bool()                                                                    const { return (Iter != nullptr); };
     };
 
-    template <typename T>
-    ReverseIterator<T> ReverseIterator<T>::operator++() {
+    template <typename T, typename Aug, typename Stats>
+    ReverseIterator<T, Aug, Stats> ReverseIterator<T, Aug, Stats>::operator++() {
         if (this->Iter != nullptr) {
-            this->Iter = this->Iter->node_Predecessor();
+            this->Iter = ads::ds::rbt::node_impl::predecessor_of<Stats>(this->Iter);
 
             return *this;
         }
         else return *this;
     }
 
-    template <typename T>
-    const ReverseIterator<T> ReverseIterator<T>::operator++(int) {
+    template <typename T, typename Aug, typename Stats>
+    const ReverseIterator<T, Aug, Stats> ReverseIterator<T, Aug, Stats>::operator++(int) {
         ReverseIterator pom = *this;
         ++(*this);
 
         return pom;
     }
 
-    template <typename T>
-    ReverseIterator<T> ReverseIterator<T>::operator--() {
+    template <typename T, typename Aug, typename Stats>
+    ReverseIterator<T, Aug, Stats> ReverseIterator<T, Aug, Stats>::operator--() {
         if (this->Iter != nullptr) {
-            this->Iter = this->Iter->node_Successor();
+            this->Iter = ads::ds::rbt::node_impl::successor_of<Stats>(this->Iter);
 
             return *this;
         }
         else return *this;
     }
 
-    template <typename T>
-    const ReverseIterator<T> ReverseIterator<T>::operator--(int) {
+    template <typename T, typename Aug, typename Stats>
+    const ReverseIterator<T, Aug, Stats> ReverseIterator<T, Aug, Stats>::operator--(int) {
         ReverseIterator pom = *this;
         --(*this);
 
@@ -0,0 +1,117 @@
+#ifndef RBTREE_RBT_ROLLING_QUANTILES_HPP
+#define RBTREE_RBT_ROLLING_QUANTILES_HPP
+
+#pragma once
+
+#include "rb_tree.hpp"
+#include "rbt_sequenced.hpp"
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <limits>
+
+namespace ads::ds::rbt {
+
+    /**
+        * Quantiles over a sliding window of samples
+        * The samples sit in an order statistic RBTree (SubtreeSize), duplicates kept apart by their arrival
+        * number (Sequenced), and a FIFO of their nodes remembers the arrival order. Expiring the oldest
+        * sample unlinks its node straight from the FIFO, no search; with a full count window a new sample
+        * takes over the node of the one it pushes out, so a running window allocates nothing.
+        * push, expire, quantile, rank and cdf are O(log n). window 0 means no count limit, expire() then
+        * drives the window (by time, for example).
+    */
+    template <typename T>
+    class RollingQuantiles {
+    public:
+        typedef T                                                              key_t;
+        typedef const T&                                                       key_ref_t;
+        typedef ads::ds::rbt::Sequenced<T>                                     entry_t;
+        typedef ads::ds::rbt::RBTree<entry_t, ads::ds::rbt::augment::SubtreeSize> tree_t;
+        typedef typename tree_t::node_ptr_t                                    node_ptr_t;
+
+        explicit RollingQuantiles(std::size_t window = 0) : window_{ window }, next_{ 0 } {};
+        ~RollingQuantiles() = default;
+
+        // The FIFO points into the tree, neither can be copied without the other
+        RollingQuantiles(const RollingQuantiles&)            = delete;
+        RollingQuantiles& operator=(const RollingQuantiles&) = delete;
+
+        std::size_t        size()    const { return order_.size(); };
+        std::size_t        window()  const { return window_; };
+        [[nodiscard]] bool isEmpty() const { return order_.empty(); };
+        void               clear()         { tree_.clear(); order_.clear(); };
+        const tree_t&      tree()    const { return tree_; };
+        key_ref_t          oldest()  const;
+        void               push(key_ref_t);
+        bool               expire();
+        T                  quantile(double q) const;
+        T                  median()           const { return quantile(0.5); };
+        std::size_t        rank(key_ref_t x)  const { return tree_.rank(entry_t{ x, 0 }); };
+        double             cdf(key_ref_t x)   const;
+
+    private:
+        tree_t                 tree_;
+        std::deque<node_ptr_t> order_;
+        std::size_t            window_;
+        std::uint64_t          next_;
+    };
+
+    template <typename T>
+    inline typename RollingQuantiles<T>::key_ref_t RollingQuantiles<T>::oldest() const {
+        if (order_.empty()) throw ads::ds::rbt::exception::TreeEmptyException();
+
+        return order_.front()->key.key;
+    }
+
+    // A full window hands the node of its oldest sample to the new one
+    template <typename T>
+    inline void RollingQuantiles<T>::push(key_ref_t x) {
+        if (window_ != 0 && order_.size() >= window_) {
+            auto* n = tree_.node_extract(order_.front());
+            order_.pop_front();
+            n->key = entry_t{ x, next_++ };
+            tree_.node_link(n);
+            order_.push_back(n);
+
+            return;
+        }
+
+        order_.push_back(tree_.insert(entry_t{ x, next_++ }).getIter());
+    }
+
+    // Drops the oldest sample, false when there is none
+    template <typename T>
+    inline bool RollingQuantiles<T>::expire() {
+        if (order_.empty()) return false;
+
+        delete tree_.node_extract(order_.front());
+        order_.pop_front();
+
+        return true;
+    }
+
+    // Nearest rank: the smallest sample with at least q of the window at or below it
+    template <typename T>
+    inline T RollingQuantiles<T>::quantile(double q) const {
+        if (order_.empty()) throw ads::ds::rbt::exception::TreeEmptyException();
+
+        auto n = order_.size();
+        auto at = (q <= 0.0 ? std::size_t{ 0 } : static_cast<std::size_t>(std::ceil(q * static_cast<double>(n))) - 1);
+
+        return tree_[at < n ? at : n - 1].key;
+    }
+
+    // Share of the window at or below x, 0 for an empty window
+    template <typename T>
+    inline double RollingQuantiles<T>::cdf(key_ref_t x) const {
+        if (order_.empty()) return 0.0;
+
+        auto upto = tree_.rank(entry_t{ x, std::numeric_limits<std::uint64_t>::max() });
+
+        return static_cast<double>(upto) / static_cast<double>(order_.size());
+    }
+
+}
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef RBTREE_RBT_SEQUENCED_HPP
+#define RBTREE_RBT_SEQUENCED_HPP
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <ostream>
+
+namespace ads::ds::rbt {
+
+    // A key and its arrival number: equal keys become distinct tree keys, ordered by arrival. Lets the adaptors
+    // keep duplicates in an RBTree, which holds every key once. Keys are ordered by a default constructed Compare.
+    template <typename T, typename Compare = std::less<T>>
+    struct Sequenced {
+        T             key;
+        std::uint64_t seq;
+
+        bool operator==(const Sequenced& s) const { return seq == s.seq && !Compare{}(key, s.key) && !Compare{}(s.key, key); };
+        bool operator!=(const Sequenced& s) const { return !(*this == s); };
+        bool operator< (const Sequenced& s) const { return Compare{}(key, s.key) || (!Compare{}(s.key, key) && seq < s.seq); };
+        bool operator> (const Sequenced& s) const { return s < *this; };
+        bool operator<=(const Sequenced& s) const { return !(s < *this); };
+        bool operator>=(const Sequenced& s) const { return !(*this < s); };
+
+        friend std::ostream& operator<<(std::ostream& ofs, const Sequenced& s) {
+            return ofs << s.key;
+        };
+    };
+
+}
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef RBTREE_RBT_SERIALIZER_HPP
+#define RBTREE_RBT_SERIALIZER_HPP
+
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include "exceptions.hpp"
+
+namespace ads::ds::rbt::serialization {
+
+    /**
+        * Snapshot file layout, all integers in the byte order of the writing machine
+        *   uint32 magic     - "RBTS", also tells a file written with the other byte order apart
+        *   uint32 version
+        *   uint32 key_bytes - sizeof(key) for keys stored as one raw block, 0 for keys written by a Serializer
+        *   uint32 reserved
+        *   uint64 size      - number of keys
+        *   keys in ascending order
+    */
+    struct SnapshotHeader {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint32_t key_bytes;
+        std::uint32_t reserved;
+        std::uint64_t size;
+    };
+
+    inline constexpr std::uint32_t snapshot_magic   = 0x53544252;
+    inline constexpr std::uint32_t snapshot_version = 1;
+
+    // Bytes left in a seekable stream, the largest value when the stream cannot tell; lengths read from a
+    // file are checked against it before anything is allocated for them
+    inline std::uint64_t remaining(std::istream& in) {
+        auto at = in.tellg();
+
+        if (at < 0 || !in.seekg(0, std::ios::end)) {
+            in.clear();
+
+            return ~std::uint64_t{ 0 };
+        }
+
+        auto end = in.tellg();
+        in.seekg(at);
+
+        return (end < at ? 0 : static_cast<std::uint64_t>(end - at));
+    }
+
+    /**
+        * Per type serializer hook
+        * Trivially copyable keys need nothing, the whole key sequence goes to disk as one block.
+        * Any other key type has to specialize Serializer with
+        *   static void write(std::ostream&, const T&)
+        *   static T    read(std::istream&)
+    */
+    template <typename T>
+    struct Serializer {
+        static_assert(std::is_trivially_copyable_v<T>, "Keys that are not trivially copyable need a Serializer specialization");
+
+        static constexpr bool raw_block = true;
+    };
+
+    template <typename T>
+    concept raw_serializable = requires { requires Serializer<T>::raw_block; };
+
+    // Length prefixed bytes
+    template <>
+    struct Serializer<std::string> {
+        static void write(std::ostream& out, const std::string& s) {
+            auto length = static_cast<std::uint64_t>(s.size());
+
+            out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+            out.write(s.data(), static_cast<std::streamsize>(s.size()));
+        };
+
+        static std::string read(std::istream& in) {
+            std::uint64_t length = 0;
+
+            if (!in.read(reinterpret_cast<char*>(&length), sizeof(length)) || length > remaining(in)) throw ads::ds::rbt::exception::TreeSnapshotException();
+
+            std::string s(static_cast<std::size_t>(length), '\0');
+
+            if (!in.read(s.data(), static_cast<std::streamsize>(length))) throw ads::ds::rbt::exception::TreeSnapshotException();
+
+            return s;
+        };
+    };
+
+}
+
+#endif
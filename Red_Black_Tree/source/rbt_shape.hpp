@@ -0,0 +1,89 @@
+#ifndef RBTREE_RBT_SHAPE_HPP
+#define RBTREE_RBT_SHAPE_HPP
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace ads::ds::rbt {
+
+    /**
+        * Shape and memory of a tree, filled by RBTree::shape_report
+        * Depths count edges from the root, height counts the nodes of the longest root to leaf path.
+        * A sampled report walks random root to leaf paths only: depth figures then describe the sampled
+        * paths, memory figures are extrapolated from the nodes on them and validation covers only them.
+    */
+    struct ShapeReport {
+        std::size_t              nodes{ 0 };
+        bool                     sampled{ false };
+        std::size_t              paths{ 0 };                 // root to leaf paths walked, every leaf when not sampled
+        std::size_t              height{ 0 };
+        double                   height_bound{ 0 };          // worst case of the balancing policy, 2 * log2(n + 1) for red-black
+        double                   average_depth{ 0 };
+        std::size_t              max_depth{ 0 };
+        std::vector<std::size_t> depth_histogram;            // nodes (paths when sampled) per depth
+        std::size_t              black_height{ 0 };
+
+        // Red-black (rank rules for AVL and WAVL) and search tree invariants
+        bool                     valid{ true };
+        std::size_t              red_root{ 0 };
+        std::size_t              red_red_violations{ 0 };
+        std::size_t              black_height_violations{ 0 };
+        std::size_t              rank_violations{ 0 };
+        std::size_t              order_violations{ 0 };
+        std::size_t              father_link_violations{ 0 };
+
+        // Memory
+        std::size_t              node_bytes{ 0 };            // sizeof(node) * nodes
+        std::size_t              payload_bytes{ 0 };         // sizeof(key) * nodes, heap owned by keys not included
+        std::size_t              allocated_bytes{ 0 };       // usable size of the node blocks as reported by the allocator
+        double                   overhead_ratio{ 0 };        // allocated bytes per payload byte
+        double                   allocator_slack{ 0 };       // share of allocated bytes the nodes do not use
+        double                   same_page_links{ 0 };       // share of father-son links inside one 4 KiB page
+
+        friend std::ostream& operator<<(std::ostream& ofs, const ShapeReport& r) {
+            ofs << "Nodes: " << r.nodes << (r.sampled ? " (sampled " : " (all ") << r.paths << " paths)\n";
+            ofs << "Height: " << r.height << ", bound: " << r.height_bound << ", average depth: " << r.average_depth << ", max depth: " << r.max_depth << "\n";
+            ofs << "Depth histogram:";
+
+            for (std::size_t d = 0; d < r.depth_histogram.size(); ++d) ofs << " " << d << ":" << r.depth_histogram[d];
+
+            ofs << "\nBlack height: " << r.black_height << ", " << (r.valid ? "valid" : "INVALID") << " (red root " << r.red_root << ", red-red " << r.red_red_violations
+                << ", black height " << r.black_height_violations << ", rank " << r.rank_violations << ", order " << r.order_violations << ", father links " << r.father_link_violations << ")\n";
+            ofs << "Node bytes: " << r.node_bytes << ", payload bytes: " << r.payload_bytes << ", allocated bytes: " << r.allocated_bytes
+                << ", overhead: " << r.overhead_ratio << "x, allocator slack: " << r.allocator_slack << ", same page links: " << r.same_page_links << "\n";
+
+            return ofs;
+        };
+    };
+
+    namespace detail {
+
+        // Usable size of a heap block, falls back to the requested size where the allocator cannot tell
+        inline std::size_t usable_size(const void* p, std::size_t requested) {
+#if defined(__GLIBC__)
+            (void)requested;
+
+            return ::malloc_usable_size(const_cast<void*>(p));
+#else
+            (void)p;
+
+            return requested;
+#endif
+        }
+
+        inline bool same_page(const void* a, const void* b) {
+            return (reinterpret_cast<std::uintptr_t>(a) >> 12) == (reinterpret_cast<std::uintptr_t>(b) >> 12);
+        }
+
+    }
+
+}
+
+#endif
@@ -0,0 +1,409 @@
+#ifndef RBTREE_RBT_SHARDED_TREE_HPP
+#define RBTREE_RBT_SHARDED_TREE_HPP
+
+#pragma once
+
+#include "rb_tree.hpp"
+#include "rbt_epoch.hpp"
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace ads::ds::rbt {
+
+    /**
+        * Range sharded Red-Black Tree
+        * The key space is cut by sorted boundaries into shards, every shard is a separate RBTree with its
+        * own lock, so writers touching different ranges never meet. Shard i holds keys in
+        * [bounds[i - 1], bounds[i]). A hot shard is split in two at its root key and the coldest pair of
+        * neighbouring shards is joined back, both in O(log n) (the shards keep subtree sizes), which keeps
+        * the number of shards fixed.
+        * insert, find and remove share no lock and no counter: the routing table is an immutable block
+        * published through an atomic pointer, readers pin an epoch slot of their own while they use it and
+        * rebalance() frees the tables and shards it replaced once no pinned reader can hold them. Every
+        * shard knows the range it owns, an update routed through a table that a rebalance just replaced
+        * finds its key outside that range under the shard lock and routes again.
+    */
+    template <typename T>
+    class ShardedRBTree {
+    public:
+        typedef T                                                             key_t;
+        typedef const T&                                                      key_ref_t;
+        typedef ads::ds::rbt::RBTree<T, ads::ds::rbt::augment::SubtreeSize>   shard_tree_t;
+        typedef ads::ds::rbt::reclamation::EpochDomain                        domain_t;
+        typedef ShardedRBTree<T>                                              self_type;
+
+        static constexpr std::size_t rebalance_period = std::size_t{ 1 } << 16;
+
+        explicit ShardedRBTree(std::vector<T> boundaries);
+        ShardedRBTree(std::size_t shards, key_ref_t lowest, key_ref_t highest);
+        ShardedRBTree(const ShardedRBTree&)            = delete;
+        ShardedRBTree& operator=(const ShardedRBTree&) = delete;
+        ~ShardedRBTree();
+
+        bool                     insert(key_ref_t);
+        bool                     find(key_ref_t) const;
+        bool                     remove(key_ref_t);
+        std::size_t              size()        const;
+        [[nodiscard]] bool       isEmpty()     const { return size() == 0; };
+        std::size_t              shard_count() const { std::shared_lock<std::shared_mutex> lock(layout_); return Table()->shards.size(); };
+        std::vector<T>           boundaries()  const { std::shared_lock<std::shared_mutex> lock(layout_); return Table()->bounds; };
+        std::vector<std::size_t> shard_sizes() const;
+        bool                     rebalance(double hot_factor = 2.0);
+        template <typename F>
+        void                     for_each(F f) const;
+        template <typename F>
+        void                     for_each_in(key_ref_t from, key_ref_t to, F f) const;
+        std::vector<T>           range(key_ref_t from, key_ref_t to) const;
+
+    private:
+        struct alignas(64) Shard {
+            shard_tree_t              tree;
+            mutable std::shared_mutex lock;
+            std::atomic<std::size_t>  hits{ 0 };
+            // Owned range [lo, hi), guarded by lock; a shard joined into its neighbour owns nothing
+            std::optional<T>          lo;
+            std::optional<T>          hi;
+            bool                      live{ true };
+
+            bool owns(key_ref_t x) const { return live && (!lo || !(x < *lo)) && (!hi || x < *hi); };
+        };
+
+        // Never changed once published, rebalance() publishes a new one
+        struct Routing {
+            std::vector<T>      bounds;
+            std::vector<Shard*> shards;
+        };
+
+        struct Retired {
+            domain_t::epoch_t epoch;
+            const Routing*    routing;
+            Shard*            shard;
+        };
+
+        // Epoch slot held for one operation, the scan for a free slot starts at a hash of the thread id
+        struct Pin {
+            explicit Pin(domain_t& d) : domain{ d }, slot{ d.acquire_slot(std::hash<std::thread::id>{}(std::this_thread::get_id())) } { domain.pin(slot); };
+            Pin(const Pin&)            = delete;
+            Pin& operator=(const Pin&) = delete;
+            ~Pin()                                                                               { domain.unpin(slot); domain.release_slot(slot); };
+
+            domain_t&   domain;
+            std::size_t slot;
+        };
+
+        static std::vector<T> Even_bounds(std::size_t, key_ref_t, key_ref_t);
+        static std::size_t    Route(const Routing&, key_ref_t);
+        static bool           Touch(Shard&);
+        const Routing*        Table() const { return routing_.load(std::memory_order_acquire); };
+        template <typename Lock>
+        Shard&                Enter(key_ref_t, Lock&) const;
+        void                  Reclaim(domain_t::epoch_t);
+
+        std::atomic<const Routing*> routing_;
+        mutable domain_t            domain_;
+        // Held shared by visits spanning several shards, exclusively by rebalance(); single key calls never take it
+        mutable std::shared_mutex   layout_;
+        std::deque<Retired>         limbo_;
+    };
+
+    template <typename T>
+    inline ShardedRBTree<T>::ShardedRBTree(std::vector<T> boundaries) {
+        auto* routing = new Routing{ std::move(boundaries), {} };
+        auto& bounds = routing->bounds;
+
+        std::sort(bounds.begin(), bounds.end());
+        bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+
+        for (std::size_t i = 0; i <= bounds.size(); ++i) {
+            auto* shard = new Shard();
+
+            if (i > 0) shard->lo = bounds[i - 1];
+            if (i < bounds.size()) shard->hi = bounds[i];
+
+            routing->shards.push_back(shard);
+        }
+
+        routing_.store(routing, std::memory_order_release);
+    }
+
+    template <typename T>
+    inline ShardedRBTree<T>::ShardedRBTree(std::size_t shards, key_ref_t lowest, key_ref_t highest) : ShardedRBTree(Even_bounds(shards, lowest, highest)) {}
+
+    template <typename T>
+    inline ShardedRBTree<T>::~ShardedRBTree() {
+        Reclaim(domain_t::idle);
+
+        auto* routing = routing_.load(std::memory_order_relaxed);
+
+        for (auto* shard : routing->shards) delete shard;
+
+        delete routing;
+    }
+
+    // Evenly spaced boundaries over [lowest, highest], for arithmetic keys
+    template <typename T>
+    inline std::vector<T> ShardedRBTree<T>::Even_bounds(std::size_t shards, key_ref_t lowest, key_ref_t highest) {
+        static_assert(std::is_arithmetic_v<T>, "Evenly spaced shards need arithmetic keys, pass boundaries instead");
+
+        std::vector<T> bounds;
+        auto width = (static_cast<long double>(highest) - static_cast<long double>(lowest)) / static_cast<long double>(shards == 0 ? 1 : shards);
+
+        for (std::size_t i = 1; i < shards; ++i) {
+            bounds.push_back(static_cast<T>(static_cast<long double>(lowest) + width * static_cast<long double>(i)));
+        }
+
+        return bounds;
+    }
+
+    template <typename T>
+    inline std::size_t ShardedRBTree<T>::Route(const Routing& routing, key_ref_t x) {
+        return static_cast<std::size_t>(std::upper_bound(routing.bounds.begin(), routing.bounds.end(), x) - routing.bounds.begin());
+    }
+
+    // Counts an update, every rebalance_period updates of one shard trigger a rebalance check
+    template <typename T>
+    inline bool ShardedRBTree<T>::Touch(Shard& shard) {
+        return (shard.hits.fetch_add(1, std::memory_order_relaxed) + 1) % rebalance_period == 0;
+    }
+
+    // Locks the shard owning x, the caller holds a Pin. A shard split or joined since the table was read
+    // no longer owns x; the table it was read from has been replaced by then, so the next round sees the new one.
+    template <typename T>
+    template <typename Lock>
+    inline typename ShardedRBTree<T>::Shard& ShardedRBTree<T>::Enter(key_ref_t x, Lock& lock) const {
+        for (;;) {
+            auto* routing = Table();
+            auto* shard = routing->shards[Route(*routing, x)];
+
+            lock = Lock(shard->lock);
+
+            if (shard->owns(x)) return *shard;
+
+            lock.unlock();
+        }
+    }
+
+    template <typename T>
+    inline bool ShardedRBTree<T>::insert(key_ref_t x) {
+        bool inserted;
+        bool hot;
+
+        {
+            Pin pin(domain_);
+            std::unique_lock<std::shared_mutex> lock;
+            auto& shard = Enter(x, lock);
+
+            inserted = static_cast<bool>(shard.tree.insert(x));
+            hot = Touch(shard);
+        }
+
+        // Checked only after the shard lock and the epoch slot are dropped
+        if (hot) rebalance();
+
+        return inserted;
+    }
+
+    template <typename T>
+    inline bool ShardedRBTree<T>::find(key_ref_t x) const {
+        Pin pin(domain_);
+        std::shared_lock<std::shared_mutex> lock;
+        auto& shard = Enter(x, lock);
+
+        return shard.tree.node_find(x) != nullptr;
+    }
+
+    template <typename T>
+    inline bool ShardedRBTree<T>::remove(key_ref_t x) {
+        bool hot;
+
+        {
+            Pin pin(domain_);
+            std::unique_lock<std::shared_mutex> lock;
+            auto& shard = Enter(x, lock);
+            auto* p = shard.tree.node_find(x);
+
+            if (p == nullptr) return false;
+
+            delete shard.tree.node_extract(p);
+            hot = Touch(shard);
+        }
+
+        if (hot) rebalance();
+
+        return true;
+    }
+
+    template <typename T>
+    inline std::size_t ShardedRBTree<T>::size() const {
+        std::size_t total = 0;
+
+        for (auto s : shard_sizes()) total += s;
+
+        return total;
+    }
+
+    template <typename T>
+    inline std::vector<std::size_t> ShardedRBTree<T>::shard_sizes() const {
+        std::shared_lock<std::shared_mutex> layout(layout_);
+        std::vector<std::size_t> sizes;
+
+        for (auto* shard : Table()->shards) {
+            std::shared_lock<std::shared_mutex> lock(shard->lock);
+            sizes.push_back(shard->tree.size());
+        }
+
+        return sizes;
+    }
+
+    // Visits every key in order, shard by shard
+    template <typename T>
+    template <typename F>
+    inline void ShardedRBTree<T>::for_each(F f) const {
+        std::shared_lock<std::shared_mutex> layout(layout_);
+
+        for (auto* shard : Table()->shards) {
+            std::shared_lock<std::shared_mutex> lock(shard->lock);
+
+            for (auto it = shard->tree.cbegin(); it != shard->tree.cend(); ++it) f(*it);
+        }
+    }
+
+    // Visits keys in [from, to] in order, crossing shard boundaries where needed
+    template <typename T>
+    template <typename F>
+    inline void ShardedRBTree<T>::for_each_in(key_ref_t from, key_ref_t to, F f) const {
+        if (to < from) return;
+
+        std::shared_lock<std::shared_mutex> layout(layout_);
+        auto* routing = Table();
+        auto last = Route(*routing, to);
+
+        for (auto i = Route(*routing, from); i <= last; ++i) {
+            auto& shard = *routing->shards[i];
+            std::shared_lock<std::shared_mutex> lock(shard.lock);
+
+            for (auto it = shard.tree.lower_bound(from); it != shard.tree.end() && !(to < *it); ++it) f(*it);
+        }
+    }
+
+    template <typename T>
+    inline std::vector<T> ShardedRBTree<T>::range(key_ref_t from, key_ref_t to) const {
+        std::vector<T> keys;
+        for_each_in(from, to, [&keys](key_ref_t x) { keys.push_back(x); });
+
+        return keys;
+    }
+
+    // Splits the hottest shard at its root key and joins the coldest neighbouring pair, returns false
+    // when no shard is hot_factor times busier than the average. The shards involved are locked while
+    // they change and the new table is published before they are unlocked, so an update waiting on one
+    // of them routes again through the new table.
+    template <typename T>
+    inline bool ShardedRBTree<T>::rebalance(double hot_factor) {
+        std::unique_lock<std::shared_mutex> layout(layout_);
+        auto* old = routing_.load(std::memory_order_relaxed);
+        auto& shards = old->shards;
+
+        if (shards.size() < 2) return false;
+
+        std::size_t total = 0;
+        std::size_t hot = 0;
+
+        for (std::size_t i = 0; i < shards.size(); ++i) {
+            total += shards[i]->hits.load(std::memory_order_relaxed);
+
+            if (shards[i]->hits.load(std::memory_order_relaxed) > shards[hot]->hits.load(std::memory_order_relaxed)) hot = i;
+        }
+
+        auto average = static_cast<double>(total) / static_cast<double>(shards.size());
+
+        if (static_cast<double>(shards[hot]->hits.load(std::memory_order_relaxed)) < hot_factor * average) return false;
+
+        // Coldest neighbouring pair apart from the hot shard
+        std::size_t cold = shards.size();
+        std::size_t cold_hits = 0;
+
+        for (std::size_t i = 0; i + 1 < shards.size(); ++i) {
+            if (i == hot || i + 1 == hot) continue;
+
+            auto pair_hits = shards[i]->hits.load(std::memory_order_relaxed) + shards[i + 1]->hits.load(std::memory_order_relaxed);
+
+            if (cold == shards.size() || pair_hits < cold_hits) {
+                cold = i;
+                cold_hits = pair_hits;
+            }
+        }
+
+        // Taken in key order, the only place holding more than one shard lock
+        std::vector<std::unique_lock<std::shared_mutex>> locks;
+
+        for (std::size_t i = 0; i < shards.size(); ++i) {
+            if (i == hot || (cold != shards.size() && (i == cold || i == cold + 1))) locks.emplace_back(shards[i]->lock);
+        }
+
+        auto* source = shards[hot];
+
+        if (source->tree.size() < 2) return false;
+
+        // Root key cuts the shard into two halves of equal black height, the root itself goes up
+        auto pivot = source->tree.getRoot()->key;
+        auto* upper = new Shard();
+        source->tree.split(pivot, upper->tree);
+        upper->lo = pivot;
+        upper->hi = source->hi;
+        source->hi = pivot;
+
+        auto half = source->hits.load(std::memory_order_relaxed) / 2;
+        source->hits.store(half, std::memory_order_relaxed);
+        upper->hits.store(half, std::memory_order_relaxed);
+
+        auto* next = new Routing(*old);
+        next->shards.insert(next->shards.begin() + static_cast<std::ptrdiff_t>(hot) + 1, upper);
+        next->bounds.insert(next->bounds.begin() + static_cast<std::ptrdiff_t>(hot), pivot);
+
+        Shard* dropped = nullptr;
+
+        if (cold != shards.size()) {
+            auto* low = shards[cold];
+            dropped = shards[cold + 1];
+
+            low->tree.join(dropped->tree);
+            low->hi = dropped->hi;
+            low->hits.store(cold_hits, std::memory_order_relaxed);
+            dropped->live = false;
+
+            auto at = (cold > hot ? cold + 1 : cold);
+            next->shards.erase(next->shards.begin() + static_cast<std::ptrdiff_t>(at) + 1);
+            next->bounds.erase(next->bounds.begin() + static_cast<std::ptrdiff_t>(at));
+        }
+
+        routing_.store(next, std::memory_order_release);
+        locks.clear();
+
+        limbo_.push_back({ domain_.advance(), old, dropped });
+        Reclaim(domain_.oldest_pinned());
+
+        return true;
+    }
+
+    // Frees the tables and shards replaced before the oldest epoch still pinned
+    template <typename T>
+    inline void ShardedRBTree<T>::Reclaim(domain_t::epoch_t oldest) {
+        while (!limbo_.empty() && (oldest == domain_t::idle || limbo_.front().epoch < oldest)) {
+            delete limbo_.front().routing;
+            delete limbo_.front().shard;
+            limbo_.pop_front();
+        }
+    }
+
+}
+
+#endif
@@ -0,0 +1,337 @@
+#ifndef RBTREE_RBT_SINGLE_WRITER_TREE_HPP
+#define RBTREE_RBT_SINGLE_WRITER_TREE_HPP
+
+#pragma once
+
+#include "rbt_epoch.hpp"
+#include "rbt_fixup.hpp"
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+namespace ads::ds::rbt {
+
+    /**
+        * One writer, any number of lock-free readers
+        * Links and the root are atomic; the writer publishes with release stores, readers follow them with
+        * acquire loads and never wait or retry. A published node is never changed but for its links, and
+        * every link store leaves a valid search path behind (relativistic rotations):
+        *   a rotation hangs a fresh copy of the node moving down under the node moving up, then swings
+        *   the father link over, so readers still on the old node keep walking its old links;
+        *   erasing a node with two sons puts a copy of its successor in its place before the successor
+        *   leaves its own, so the successor key is reachable all along.
+        * Replaced and unlinked nodes are kept until every reader pinned before the change has left (epoch
+        * based reclamation). Color and father links are read by the writer only.
+    */
+    template <typename T>
+    class SingleWriterRBTree {
+    public:
+        struct Node {
+            Node(const T& k, Node* f, bool r) : key{ k }, sons{ nullptr, nullptr }, father{ f }, red{ r } {};
+
+            const T            key;
+            std::atomic<Node*> sons[2];     // 0 left, 1 right
+            Node*              father;
+            bool               red;
+        };
+
+        typedef T                                                key_t;
+        typedef const T&                                         key_ref_t;
+        typedef Node                                             node_t;
+        typedef Node*                                            node_ptr_t;
+        typedef ads::ds::rbt::reclamation::EpochDomain           domain_t;
+        typedef SingleWriterRBTree<T>                            self_type;
+
+        class Reader;
+
+        static constexpr std::size_t reclaim_threshold = 64;
+
+        SingleWriterRBTree()                                     : root_{ nullptr }, size_{ 0 } {};
+        SingleWriterRBTree(const SingleWriterRBTree&)            = delete;
+        SingleWriterRBTree& operator=(const SingleWriterRBTree&) = delete;
+        ~SingleWriterRBTree()                                                                  { Chop(root_.load(std::memory_order_relaxed)); Reclaim(domain_t::idle); };
+
+        /**
+            * Writer side, calls are serialized
+        */
+        bool        insert(key_ref_t);
+        bool        remove(key_ref_t);
+        void        reclaim()                                                                  { std::lock_guard<std::mutex> lock(writer_); Reclaim(domain_.oldest_pinned()); };
+        std::size_t retired() const                                                            { return limbo_.size(); };
+
+        /**
+            * Reader side, a Reader handle keeps its epoch slot for the whole lifetime of a thread,
+            * the plain calls below borrow a slot for one operation
+        */
+        Reader              reader() const                                                     { return Reader(*this); };
+        bool                find(key_ref_t) const;
+        std::optional<T>    lower_bound(key_ref_t) const;
+        std::size_t         size()    const noexcept                                           { return size_.load(std::memory_order_relaxed); };
+        [[nodiscard]] bool  isEmpty() const noexcept                                           { return size() == 0; };
+
+    private:
+        struct Retired {
+            domain_t::epoch_t epoch;
+            Node*             node;
+        };
+
+        // Link access for the shared red-black fixups (rbt_fixup.hpp), the writer reads its own stores
+        struct Links {
+            typedef Node* handle_t;
+
+            static constexpr Node* nil = nullptr;
+
+            SingleWriterRBTree& t;
+
+            Node* root()                const { return t.root_.load(std::memory_order_relaxed); };
+            Node* son(Node* n, int d)   const { return n->sons[d].load(std::memory_order_relaxed); };
+            Node* father(Node* n)       const { return n->father; };
+            bool  red(Node* n)          const { return n != nullptr && n->red; };
+            void  paint(Node* n, bool red)    { n->red = red; };
+            Node* rotate(Node* n, int d)      { return t.Rotate(n, d); };
+        };
+
+        static Node*                         Son(const Node* n, int d)                         { return n->sons[d].load(std::memory_order_relaxed); };
+        static void                          Hang(Node*, int, Node*);
+        static void                          Chop(Node*);
+        void                                 Replace(Node*, Node*);
+        Node*                                Rotate(Node*, int);
+        void                                 Unlink(Node*);
+        void                                 Retire(Node*);
+        void                                 Reclaim(domain_t::epoch_t);
+        bool                                 Find(key_ref_t) const;
+        std::optional<T>                     Lower_bound(key_ref_t) const;
+
+        std::atomic<Node*>       root_;
+        std::atomic<std::size_t> size_;
+        mutable domain_t         domain_;
+        std::mutex               writer_;
+        std::deque<Retired>      limbo_;
+    };
+
+    template <typename T>
+    class SingleWriterRBTree<T>::Reader {
+    public:
+        explicit Reader(const SingleWriterRBTree<T>& tree) : tree_{ &tree }, slot_{ tree.domain_.acquire_slot() } {};
+        Reader(const Reader&)            = delete;
+        Reader(Reader&& s) noexcept                        : tree_{ s.tree_ }, slot_{ s.slot_ } { s.tree_ = nullptr; };
+        Reader& operator=(const Reader&) = delete;
+        ~Reader()                                                                               { if (tree_) tree_->domain_.release_slot(slot_); };
+
+        bool find(key_ref_t x) const {
+            domain_t::Guard guard(tree_->domain_, slot_);
+
+            return tree_->Find(x);
+        };
+
+        std::optional<T> lower_bound(key_ref_t x) const {
+            domain_t::Guard guard(tree_->domain_, slot_);
+
+            return tree_->Lower_bound(x);
+        };
+
+    private:
+        const SingleWriterRBTree<T>* tree_;
+        std::size_t                  slot_;
+    };
+
+    // Sets son d of a node no reader can reach yet, its publication orders the store
+    template <typename T>
+    inline void SingleWriterRBTree<T>::Hang(Node* n, int d, Node* s) {
+        n->sons[d].store(s, std::memory_order_relaxed);
+
+        if (s != nullptr) s->father = n;
+    }
+
+    // Points the father link of u (the root for none) at v
+    template <typename T>
+    inline void SingleWriterRBTree<T>::Replace(Node* u, Node* v) {
+        auto* f = u->father;
+
+        if (f == nullptr) root_.store(v, std::memory_order_release);
+        else f->sons[Son(f, 0) == u ? 0 : 1].store(v, std::memory_order_release);
+
+        if (v != nullptr) v->father = f;
+    }
+
+    // Moves n down to side d as a copy, its son y on the other side takes its place. The copy is hung
+    // under y first: a reader still on n goes on to y and then into the copy, which leads to the same keys.
+    template <typename T>
+    inline typename SingleWriterRBTree<T>::Node* SingleWriterRBTree<T>::Rotate(Node* n, int d) {
+        auto* y = Son(n, 1 - d);
+        auto* c = new Node(n->key, y, n->red);
+
+        Hang(c, d, Son(n, d));
+        Hang(c, 1 - d, Son(y, d));
+        y->sons[d].store(c, std::memory_order_release);
+        Replace(n, y);
+        Retire(n);
+
+        return c;
+    }
+
+    template <typename T>
+    inline bool SingleWriterRBTree<T>::insert(key_ref_t x) {
+        std::lock_guard<std::mutex> lock(writer_);
+        Node* q = nullptr;
+        auto* p = root_.load(std::memory_order_relaxed);
+        auto d = 0;
+
+        while (p != nullptr) {
+            if (x < p->key) d = 0;
+            else if (p->key < x) d = 1;
+            else return false;
+
+            q = p;
+            p = Son(p, d);
+        }
+
+        // The node is complete before it becomes reachable
+        auto* create = new Node(x, q, true);
+
+        if (q == nullptr) root_.store(create, std::memory_order_release);
+        else q->sons[d].store(create, std::memory_order_release);
+
+        Links links{ *this };
+        ads::ds::rbt::fixup::insert_fix(links, create);
+        size_.fetch_add(1, std::memory_order_relaxed);
+
+        return true;
+    }
+
+    template <typename T>
+    inline bool SingleWriterRBTree<T>::remove(key_ref_t x) {
+        std::lock_guard<std::mutex> lock(writer_);
+        auto* p = root_.load(std::memory_order_relaxed);
+
+        while (p != nullptr && !(p->key == x)) p = Son(p, x < p->key ? 0 : 1);
+
+        if (p == nullptr) return false;
+
+        Unlink(p);
+        size_.fetch_sub(1, std::memory_order_relaxed);
+
+        return true;
+    }
+
+    // A node with two sons gives its place to a copy of its successor y, and only then y leaves its own
+    // place: until the second store y's key sits in the tree twice, never zero times
+    template <typename T>
+    inline void SingleWriterRBTree<T>::Unlink(Node* p) {
+        Links links{ *this };
+        auto* l = Son(p, 0);
+        auto* r = Son(p, 1);
+        auto removed_red = p->red;
+        Node* q;
+        Node* q_father;
+
+        if (l == nullptr || r == nullptr) {
+            q = (l == nullptr ? r : l);
+            q_father = p->father;
+            Replace(p, q);
+        }
+        else {
+            auto* y = ads::ds::rbt::fixup::outer(links, r, 0);
+            auto* c = new Node(y->key, nullptr, p->red);
+            removed_red = y->red;
+            q = Son(y, 1);
+
+            Hang(c, 0, l);
+
+            if (y == r) {
+                Hang(c, 1, q);
+                q_father = c;
+                Replace(p, c);
+            }
+            else {
+                Hang(c, 1, r);
+                q_father = y->father;
+                Replace(p, c);
+                Replace(y, q);
+            }
+
+            Retire(y);
+        }
+
+        Retire(p);
+
+        if (!removed_red) ads::ds::rbt::fixup::delete_fix(links, q, q_father);
+    }
+
+    template <typename T>
+    inline void SingleWriterRBTree<T>::Retire(Node* p) {
+        limbo_.push_back({ domain_.advance(), p });
+
+        if (limbo_.size() >= reclaim_threshold) Reclaim(domain_.oldest_pinned());
+    }
+
+    // Frees every node unlinked before the oldest epoch still pinned by a reader
+    template <typename T>
+    inline void SingleWriterRBTree<T>::Reclaim(domain_t::epoch_t oldest) {
+        while (!limbo_.empty() && (oldest == domain_t::idle || limbo_.front().epoch < oldest)) {
+            delete limbo_.front().node;
+            limbo_.pop_front();
+        }
+    }
+
+    template <typename T>
+    inline void SingleWriterRBTree<T>::Chop(Node* n) {
+        if (n == nullptr) return;
+
+        Chop(Son(n, 0));
+        Chop(Son(n, 1));
+        delete n;
+    }
+
+    template <typename T>
+    inline bool SingleWriterRBTree<T>::find(key_ref_t x) const {
+        Reader r(*this);
+
+        return r.find(x);
+    }
+
+    template <typename T>
+    inline std::optional<T> SingleWriterRBTree<T>::lower_bound(key_ref_t x) const {
+        Reader r(*this);
+
+        return r.lower_bound(x);
+    }
+
+    template <typename T>
+    inline bool SingleWriterRBTree<T>::Find(key_ref_t x) const {
+        auto* t = root_.load(std::memory_order_acquire);
+
+        while (t != nullptr) {
+            if (t->key == x) return true;
+
+            t = t->sons[x < t->key ? 0 : 1].load(std::memory_order_acquire);
+        }
+
+        return false;
+    }
+
+    template <typename T>
+    inline std::optional<T> SingleWriterRBTree<T>::Lower_bound(key_ref_t x) const {
+        auto* t = root_.load(std::memory_order_acquire);
+        const Node* best = nullptr;
+
+        while (t != nullptr) {
+            if (t->key < x) t = t->sons[1].load(std::memory_order_acquire);
+            else {
+                best = t;
+
+                if (t->key == x) break;
+
+                t = t->sons[0].load(std::memory_order_acquire);
+            }
+        }
+
+        if (best == nullptr) return std::nullopt;
+
+        return best->key;
+    }
+
+}
+
+#endif
@@ -0,0 +1,154 @@
+#ifndef RBTREE_RBT_STATS_HPP
+#define RBTREE_RBT_STATS_HPP
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace ads::ds::rbt::stats {
+
+    /**
+        * Hot path instrumentation
+        * The tree reports events to its Stats policy through Stats::count(event, n). NoStats, the default,
+        * compiles every call away. Counting keeps one set of relaxed atomic counters, ThreadLocal keeps a
+        * set per thread that only its owner writes and sums all of them on snapshot(), so concurrent trees
+        * never fight over a counter cache line. Counters belong to the policy type, not to a tree: every
+        * tree instantiated with the same Counting<Tag> or ThreadLocal<Tag> shares them, so Tag has no
+        * default and a tree (or a group of trees) that wants counters of its own names a Tag of its own.
+    */
+    enum event : std::size_t {
+        comparison,         // key comparisons evaluated on search and insert paths, up to three per node in find
+        descent,            // searches and insert paths started at the root
+        rotation,
+        recolor,            // color changes, rank changes under the AVL and WAVL policies
+        insert_fix_step,    // loop iterations of Insert_fix
+        delete_fix_step,    // loop iterations of Delete_fix
+        successor_climb,    // father links followed by iterator increments and decrements
+        allocation,
+        deallocation,
+        event_count
+    };
+
+    typedef std::array<std::uint64_t, event_count> counts_t;
+
+    struct Snapshot {
+        std::uint64_t comparisons;
+        std::uint64_t descents;
+        std::uint64_t rotations;
+        std::uint64_t recolors;
+        std::uint64_t insert_fix_steps;
+        std::uint64_t delete_fix_steps;
+        std::uint64_t successor_climbs;
+        std::uint64_t allocations;
+        std::uint64_t deallocations;
+
+        static Snapshot from(const counts_t& c) {
+            return { c[comparison], c[descent], c[rotation], c[recolor], c[insert_fix_step], c[delete_fix_step], c[successor_climb], c[allocation], c[deallocation] };
+        };
+
+        double comparisons_per_descent() const { return (descents == 0 ? 0.0 : static_cast<double>(comparisons) / static_cast<double>(descents)); };
+        std::uint64_t live_nodes()       const { return allocations - deallocations; };
+    };
+
+    struct NoStats {
+        static constexpr bool enabled = false;
+
+        static void     count(event, std::uint64_t = 1) noexcept {};
+        static Snapshot snapshot()                               { return {}; };
+        static void     reset()                                  {};
+    };
+
+    template <typename Tag>
+    struct Counting {
+        static constexpr bool enabled = true;
+
+        static void count(event e, std::uint64_t n = 1) noexcept { counters_[e].fetch_add(n, std::memory_order_relaxed); };
+
+        static Snapshot snapshot() {
+            counts_t c{};
+
+            for (std::size_t i = 0; i < event_count; ++i) c[i] = counters_[i].load(std::memory_order_relaxed);
+
+            return Snapshot::from(c);
+        };
+
+        static void reset() {
+            for (auto& counter : counters_) counter.store(0, std::memory_order_relaxed);
+        };
+
+    private:
+        static inline std::array<std::atomic<std::uint64_t>, event_count> counters_{};
+    };
+
+    template <typename Tag>
+    struct ThreadLocal {
+        static constexpr bool enabled = true;
+
+        // Only the owning thread writes, a plain load and store is enough and costs no locked instruction
+        static void count(event e, std::uint64_t n = 1) noexcept {
+            auto& counter = Local().counters[e];
+            counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        };
+
+        static Snapshot snapshot() {
+            std::lock_guard<std::mutex> lock(lock_);
+            auto c = finished_;
+
+            for (auto* block : blocks_) {
+                for (std::size_t i = 0; i < event_count; ++i) c[i] += block->counters[i].load(std::memory_order_relaxed);
+            }
+
+            return Snapshot::from(c);
+        };
+
+        // Increments racing with a reset may survive it
+        static void reset() {
+            std::lock_guard<std::mutex> lock(lock_);
+            finished_ = {};
+
+            for (auto* block : blocks_) {
+                for (auto& counter : block->counters) counter.store(0, std::memory_order_relaxed);
+            }
+        };
+
+    private:
+        struct alignas(64) Block {
+            std::array<std::atomic<std::uint64_t>, event_count> counters{};
+        };
+
+        // Registers the block of a thread on first use, a finishing thread folds its counts into finished_
+        struct Registration {
+            Block block;
+
+            Registration() {
+                std::lock_guard<std::mutex> lock(lock_);
+                blocks_.push_back(&block);
+            };
+
+            ~Registration() {
+                std::lock_guard<std::mutex> lock(lock_);
+
+                for (std::size_t i = 0; i < event_count; ++i) finished_[i] += block.counters[i].load(std::memory_order_relaxed);
+
+                std::erase(blocks_, &block);
+            };
+        };
+
+        static Block& Local() {
+            thread_local Registration registration;
+
+            return registration.block;
+        };
+
+        static inline std::mutex          lock_;
+        static inline std::vector<Block*> blocks_;
+        static inline counts_t            finished_{};
+    };
+
+}
+
+#endif
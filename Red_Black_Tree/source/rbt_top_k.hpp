@@ -0,0 +1,104 @@
+#ifndef RBTREE_RBT_TOP_K_HPP
+#define RBTREE_RBT_TOP_K_HPP
+
+#pragma once
+
+#include "rb_tree.hpp"
+#include "rbt_sequenced.hpp"
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+namespace ads::ds::rbt {
+
+    /**
+        * The K heaviest items of a stream
+        * An RBTree of at most K items ordered by Compare (heavier = greater), its lightest node held at hand.
+        * An item that is not heavier than that node is turned away after one comparison, no descent and no
+        * allocation. A heavier one takes over the node of the lightest item: unlinked, refilled and linked
+        * again, O(log K), so the tree never holds more than K nodes once full.
+        * Of equally heavy items the earliest ones stay: arrival numbers (Sequenced) count down, so the earlier
+        * of two equal items is the heavier one, and a tie with the lightest item is not admitted.
+    */
+    template <typename T, typename Compare = std::less<T>>
+    class TopK {
+    public:
+        typedef T                                        key_t;
+        typedef const T&                                 key_ref_t;
+        typedef ads::ds::rbt::Sequenced<T, Compare>      entry_t;
+        typedef ads::ds::rbt::RBTree<entry_t>            tree_t;
+        typedef typename tree_t::node_ptr_t              node_ptr_t;
+
+        explicit TopK(std::size_t k) : k_{ k }, min_{ nullptr }, next_{ std::numeric_limits<std::uint64_t>::max() } {};
+        ~TopK() = default;
+
+        // min_ points into the tree, neither can be copied without the other
+        TopK(const TopK&)            = delete;
+        TopK& operator=(const TopK&) = delete;
+
+        std::size_t        size()     const { return tree_.size(); };
+        std::size_t        capacity() const { return k_; };
+        [[nodiscard]] bool isEmpty()  const { return min_ == nullptr; };
+        [[nodiscard]] bool isFull()   const { return tree_.size() >= k_; };
+        void               clear()          { tree_.clear(); min_ = nullptr; };
+        const tree_t&      tree()     const { return tree_; };
+        key_ref_t          min()      const;
+        bool               admits(key_ref_t x) const { return k_ != 0 && (!isFull() || Compare{}(min_->key.key, x)); };
+        bool               push(key_ref_t);
+        std::vector<T>     items()    const;
+
+    private:
+        std::size_t   k_;
+        tree_t        tree_;
+        node_ptr_t    min_;
+        std::uint64_t next_;
+    };
+
+    // Lightest item kept, the bar a new item has to clear once the tracker is full
+    template <typename T, typename Compare>
+    inline typename TopK<T, Compare>::key_ref_t TopK<T, Compare>::min() const {
+        if (min_ == nullptr) throw ads::ds::rbt::exception::TreeEmptyException();
+
+        return min_->key.key;
+    }
+
+    // True when x was kept
+    template <typename T, typename Compare>
+    inline bool TopK<T, Compare>::push(key_ref_t x) {
+        if (!admits(x)) return false;
+
+        if (!isFull()) {
+            auto* n = tree_.insert(entry_t{ x, next_-- }).getIter();
+
+            if (min_ == nullptr || n->key < min_->key) min_ = n;
+
+            return true;
+        }
+
+        // The successor of the lightest node is the lightest one left, x may still fall below it
+        auto* n = min_;
+        auto* next = ads::ds::rbt::node_impl::successor_of<typename tree_t::stats_t>(n);
+
+        tree_.node_extract(n);
+        n->key = entry_t{ x, next_-- };
+        tree_.node_link(n);
+        min_ = (next == nullptr || n->key < next->key ? n : next);
+
+        return true;
+    }
+
+    // Heaviest first
+    template <typename T, typename Compare>
+    inline std::vector<T> TopK<T, Compare>::items() const {
+        std::vector<T> out;
+        out.reserve(tree_.size());
+
+        for (auto it = tree_.crbegin(); it != tree_.crend(); ++it) out.push_back((*it).key);
+
+        return out;
+    }
+
+}
+
+#endif